@@ -0,0 +1,110 @@
+/*
+ * A computer player that plans its way to the fruit. See autopilot.h.
+ */
+
+// Import header files.
+#include "autopilot.h"
+
+using namespace std;
+
+void CellSet::clear(int width, long area)
+{
+    bool fits = (area <= DENSE_BOARD_AREA);
+    if (fits != dense || width != this->width
+        || (fits && (long)stamps.size() != area))
+    {
+        // A new board: start over with storage for it.
+        this->width = width;
+        dense = fits;
+        stamps.assign(dense ? area : 0, 0);
+        Slot empty = {0, 0};
+        slots.assign(dense ? 0 : MIN_SLOTS, empty);
+        mask = slots.empty() ? 0 : slots.size() - 1;
+        stamp = 0;
+    }
+
+    // Slots holding an older stamp count as empty, so bumping the
+    // stamp empties the set. Wrapping around needs a real clear.
+    stamp++;
+    if (stamp == 0)
+    {
+        fill(stamps.begin(), stamps.end(), 0);
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            slots[i].stamp = 0;
+        }
+        stamp = 1;
+    }
+    used = 0;
+}
+
+bool CellSet::insert(Cell cell)
+{
+    long key = cellIndex(cell, width);
+    if (dense)
+    {
+        if (stamps[key] == stamp)
+        {
+            return false;
+        }
+        stamps[key] = stamp;
+        return true;
+    }
+
+    size_t i = home(key);
+    while (slots[i].stamp == stamp)
+    {
+        if (slots[i].key == key)
+        {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+    if ((used + 1)*2 > slots.size())
+    {
+        grow();
+        return insert(cell);
+    }
+    slots[i].key = key;
+    slots[i].stamp = stamp;
+    used++;
+    return true;
+}
+
+bool CellSet::contains(Cell cell) const
+{
+    long key = cellIndex(cell, width);
+    if (dense)
+    {
+        return stamps[key] == stamp;
+    }
+    for (size_t i = home(key); slots[i].stamp == stamp; i = (i + 1) & mask)
+    {
+        if (slots[i].key == key)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CellSet::grow()
+{
+    vector<Slot> old;
+    old.swap(slots);
+    Slot empty = {0, 0};
+    slots.assign(old.size()*2, empty);
+    mask = slots.size() - 1;
+    for (size_t i = 0; i < old.size(); i++)
+    {
+        if (old[i].stamp == stamp)
+        {
+            size_t j = home(old[i].key);
+            while (slots[j].stamp == stamp)
+            {
+                j = (j + 1) & mask;
+            }
+            slots[j] = old[i];
+        }
+    }
+}
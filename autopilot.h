@@ -0,0 +1,435 @@
+/*
+ * A computer player that plans its way to the fruit.
+ *
+ * When the fruit appears, or the snake leaves the plan, it searches
+ * for a shortest path from the head to the fruit with A* over the
+ * board, then checks that once the snake has followed the path and
+ * grown, its head could still reach its tail. A path that passes
+ * the check is followed one move per tick with no further search,
+ * since nothing on the board changes but the snake following it.
+ * With no safe path it stalls, taking the move from which the tail
+ * stays in reach, or failing that the one with the most room.
+ *
+ * Search buffers are kept between searches and only grow, and the
+ * sets of visited cells are cleared by bumping a stamp, so a search
+ * allocates nothing once the snake has been around for a while. On
+ * boards too large for a flat array the sets are hash tables holding
+ * just the cells the search reached.
+ */
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "gameState.h"
+#include "policy.h"
+
+/*
+ * A set of board cells emptied in O(1) by starting a new stamp: a
+ * cell is in the set when its slot holds the current stamp.
+ */
+class CellSet {
+    public:
+        // Empty the set, for a board of the given width and area.
+        void clear(int width, long area);
+
+        // Add a cell. Returns false if it was already there.
+        bool insert(Cell cell);
+
+        bool contains(Cell cell) const;
+
+        CellSet(): width(0), stamp(0), dense(true), used(0), mask(0)
+        {
+        }
+
+    private:
+        struct Slot {
+            long key;
+            uint32_t stamp;
+        };
+
+        static const size_t MIN_SLOTS = 256;
+
+        int width;
+        uint32_t stamp;
+        bool dense;
+
+        // One stamp per cell on a dense board.
+        std::vector<uint32_t> stamps;
+
+        // Open addressing on a large one, kept at most half full.
+        std::vector<Slot> slots;
+        size_t used;
+        size_t mask;
+
+        size_t home(long key) const
+        {
+            return (((uint64_t)key*0x9e3779b97f4a7c15ULL) >> 32) & mask;
+        }
+
+        void grow();
+};
+
+class AutopilotPolicy: public Policy {
+    public:
+        virtual Input choose(const GameState &game) { return pick(game); }
+
+        template <class Game>
+        Input pick(const Game &game);
+
+        AutopilotPolicy(): planned(false), nextStep(0), retryDelay(1), retryIn(0)
+        {
+        }
+
+    private:
+        // Most ticks to stall between searches for a way to the same
+        // fruit.
+        static const int MAX_RETRY_DELAY = 16;
+
+        /*
+         * A cell reached by a search, with the search node it was
+         * reached from and its distance from the start.
+         */
+        struct Node {
+            Cell cell;
+            int parent;
+            int distance;
+        };
+
+        // Open search nodes, ordered by estimated path length and
+        // then by distance, furthest first.
+        struct Open {
+            long estimate;
+            int distance;
+            int node;
+
+            bool operator<(const Open &other) const
+            {
+                if (estimate != other.estimate)
+                {
+                    return estimate > other.estimate;
+                }
+                return distance < other.distance;
+            }
+        };
+
+        // The plan being followed: cells from the head to the fruit,
+        // and where the snake should be to take the next one.
+        std::vector<Cell> path;
+        bool planned;
+        size_t nextStep;
+        Cell expectedHead;
+        Cell plannedFruit;
+        size_t expectedLength;
+
+        // Ticks to stall after the next search that finds no safe
+        // path, and ticks left to stall before searching again.
+        int retryDelay;
+        int retryIn;
+
+        // Search buffers, reused.
+        std::vector<Node> nodes;
+        std::vector<Open> open;
+        CellSet closed;
+        CellSet blocked;
+        std::vector<Cell> future;
+        std::vector<Cell> frontier;
+
+        template <class Game>
+        bool planToFruit(const Game &game);
+
+        template <class Game>
+        Input stall(const Game &game);
+
+        template <class Game>
+        bool findPath(const Game &game, Cell to);
+
+        template <class Game>
+        bool isBlocked(const Game &game, Cell cell, int distance) const;
+
+        template <class Game>
+        bool reachTail(const Game &game, size_t limit, size_t &reached);
+};
+
+template <class Game>
+Input AutopilotPolicy::pick(const Game &game)
+{
+    Cell head = game.getBody().front();
+    Cell fruit = game.getFruit();
+
+    // Carry on with the plan if the snake is where it expects, with
+    // the same fruit, and has not grown since.
+    bool sameFruit = fruit.x == plannedFruit.x && fruit.y == plannedFruit.y
+                     && game.getBody().size() == expectedLength;
+    bool onPlan = planned && sameFruit && nextStep < path.size()
+                  && head.x == expectedHead.x && head.y == expectedHead.y;
+    if (!onPlan)
+    {
+        // A way to the fruit only opens up as the tail moves off, so
+        // after each search that finds none stall for longer before
+        // the next.
+        if (!sameFruit)
+        {
+            retryDelay = 1;
+            retryIn = 0;
+        }
+        if (retryIn > 0)
+        {
+            retryIn--;
+            return stall(game);
+        }
+
+        planned = planToFruit(game);
+        nextStep = 0;
+        plannedFruit = fruit;
+        expectedLength = game.getBody().size();
+        if (!planned)
+        {
+            retryIn = retryDelay;
+            if (retryDelay < MAX_RETRY_DELAY)
+            {
+                retryDelay *= 2;
+            }
+            return stall(game);
+        }
+        retryDelay = 1;
+    }
+
+    Cell next = path[nextStep++];
+    expectedHead = next;
+    Direction direction = stepDirection(head, next);
+    return directionInput(direction);
+}
+
+// Plan a path to the fruit that leaves the tail in reach afterwards.
+template <class Game>
+bool AutopilotPolicy::planToFruit(const Game &game)
+{
+    Cell head = game.getBody().front();
+    Cell fruit = game.getFruit();
+    if (fruit.x < 0 || !findPath(game, fruit))
+    {
+        return false;
+    }
+
+    // Take the path out of the search, head end first.
+    path.clear();
+    for (int n = (int)nodes.size() - 1; nodes[n].parent >= 0; n = nodes[n].parent)
+    {
+        path.push_back(nodes[n].cell);
+    }
+    std::reverse(path.begin(), path.end());
+
+    // The snake after following the path and eating, head first.
+    size_t length = game.getBody().size() + 1;
+    future.clear();
+    for (size_t i = path.size(); i > 0 && future.size() < length; i--)
+    {
+        future.push_back(path[i - 1]);
+    }
+    for (size_t i = 0; future.size() < length; i++)
+    {
+        future.push_back(game.getBody()[i]);
+    }
+
+    // A snake that fills the board after eating has won.
+    long area = (long)game.getWidth()*game.getHeight();
+    if ((long)length < area)
+    {
+        // Reaching several times more cells than the snake is long
+        // without meeting the tail leaves it room enough for now.
+        size_t limit = 4*length + 64;
+        size_t reached;
+        if (!reachTail(game, limit, reached) && reached < limit)
+        {
+            return false;
+        }
+    }
+
+    expectedHead = head;
+    return true;
+}
+
+// With no safe path to the fruit, make the move that keeps the tail
+// in reach, or failing that has the most room. Returns INPUT_NONE
+// when every move dies.
+template <class Game>
+Input AutopilotPolicy::stall(const Game &game)
+{
+    const size_t limit = 4*game.getBody().size() + 64;
+    Input best = INPUT_NONE;
+    size_t bestRoom = 0;
+    for (int d = 0; d < 4; d++)
+    {
+        Direction direction = (Direction)d;
+        if (!isSafeMove(game, direction))
+        {
+            continue;
+        }
+
+        // The snake after the move, head first. Eating keeps the tail.
+        Cell next = neighbour(game.getBody().front(), direction);
+        Cell fruit = game.getFruit();
+        bool ate = (next.x == fruit.x && next.y == fruit.y);
+        size_t length = game.getBody().size() + (ate ? 1 : 0);
+        future.clear();
+        future.push_back(next);
+        for (size_t i = 0; future.size() < length; i++)
+        {
+            future.push_back(game.getBody()[i]);
+        }
+
+        // A snake of one cell has no tail to lose.
+        size_t room = limit;
+        bool findsTail = true;
+        if (future.size() > 1)
+        {
+            findsTail = reachTail(game, limit, room);
+        }
+        if (findsTail)
+        {
+            return directionInput(direction);
+        }
+        if (best == INPUT_NONE || room > bestRoom)
+        {
+            best = directionInput(direction);
+            bestRoom = room;
+        }
+    }
+    return best;
+}
+
+// Whether the snake is in the way of a cell reached at a distance.
+// The tail moves away after the first move unless the fruit is eaten.
+template <class Game>
+bool AutopilotPolicy::isBlocked(const Game &game, Cell cell, int distance) const
+{
+    if (!game.contains(cell))
+    {
+        return true;
+    }
+    if (!game.covers(cell))
+    {
+        return false;
+    }
+    Cell tail = game.getBody().back();
+    Cell fruit = game.getFruit();
+    bool ate = (cell.x == fruit.x && cell.y == fruit.y);
+    return !(distance == 1 && !ate && cell.x == tail.x && cell.y == tail.y);
+}
+
+/*
+ * A* search from the head to a cell around the snake. On success the
+ * last node holds the goal. A way around the snake is seldom much
+ * longer than the snake, so the search gives up after expanding a few
+ * times the snake's length plus the straight distance. Otherwise a
+ * goal walled off by the body would flood the whole of a large board.
+ */
+template <class Game>
+bool AutopilotPolicy::findPath(const Game &game, Cell to)
+{
+    Cell from = game.getBody().front();
+    size_t limit = 4*(game.getBody().size() + (size_t)abs(to.x - from.x)
+                      + (size_t)abs(to.y - from.y)) + 64;
+    size_t expanded = 0;
+    nodes.clear();
+    open.clear();
+    closed.clear(game.getWidth(), (long)game.getWidth()*game.getHeight());
+
+    Node start = {from, -1, 0};
+    nodes.push_back(start);
+    Open first = {(long)abs(to.x - from.x) + abs(to.y - from.y), 0, 0};
+    open.push_back(first);
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end());
+        int current = open.back().node;
+        open.pop_back();
+        Cell cell = nodes[current].cell;
+        if (!closed.insert(cell))
+        {
+            continue;
+        }
+        if (++expanded > limit)
+        {
+            return false;
+        }
+
+        for (int d = 0; d < 4; d++)
+        {
+            // Never turn straight back on the first move.
+            if (current == 0 && (d ^ game.getDirection()) == 2)
+            {
+                continue;
+            }
+
+            Cell next = neighbour(cell, (Direction)d);
+            int distance = nodes[current].distance + 1;
+            if (next.x == to.x && next.y == to.y)
+            {
+                Node goal = {next, current, distance};
+                nodes.push_back(goal);
+                return true;
+            }
+            if (isBlocked(game, next, distance) || closed.contains(next))
+            {
+                continue;
+            }
+
+            Node node = {next, current, distance};
+            nodes.push_back(node);
+            Open entry = {distance + (long)abs(to.x - next.x) + abs(to.y - next.y), distance,
+                          (int)nodes.size() - 1};
+            open.push_back(entry);
+            std::push_heap(open.begin(), open.end());
+        }
+    }
+    return false;
+}
+
+/*
+ * Whether the head of the future body can reach its tail, by a
+ * breadth-first flood around the rest of it. Gives up after reaching
+ * limit cells. reached is the number of cells reached.
+ */
+template <class Game>
+bool AutopilotPolicy::reachTail(const Game &game, size_t limit, size_t &reached)
+{
+    long area = (long)game.getWidth()*game.getHeight();
+    blocked.clear(game.getWidth(), area);
+    for (size_t i = 0; i + 1 < future.size(); i++)
+    {
+        blocked.insert(future[i]);
+    }
+    Cell tail = future.back();
+
+    frontier.clear();
+    frontier.push_back(future.front());
+    reached = 1;
+    for (size_t i = 0; i < frontier.size() && reached < limit; i++)
+    {
+        for (int d = 0; d < 4; d++)
+        {
+            Cell next = neighbour(frontier[i], (Direction)d);
+            if (next.x == tail.x && next.y == tail.y)
+            {
+                return true;
+            }
+
+            // Cells reached join the blocked set, so it doubles as
+            // the set of cells seen.
+            if (game.contains(next) && blocked.insert(next))
+            {
+                frontier.push_back(next);
+                reached++;
+            }
+        }
+    }
+    return false;
+}
+
+#endif
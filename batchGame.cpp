@@ -0,0 +1,207 @@
+/*
+ * A batch of independent Snake games. See batchGame.h.
+ */
+
+// Import header files.
+#include "batchGame.h"
+
+using namespace std;
+
+// Fruit placement attempts before falling back to a scan.
+const int FRUIT_ATTEMPTS = 16;
+
+BatchGame::BatchGame(int count, int width, int height, uint64_t seed):
+    count(count), width(width), height(height), area(width*height),
+    wordsPerGame((width*height + 63)/64),
+    headX(count), headY(count), direction(count), length(count),
+    fruitX(count), fruitY(count), score(count), bodyStart(count), random(count),
+    nextX(count), nextY(count), hitWall(count), ate(count),
+    reward(count), done(count), finalScore(count),
+    bodyCells((size_t)count*width*height),
+    occupied((size_t)count*((width*height + 63)/64))
+{
+    for (int i = 0; i < count; i++)
+    {
+        random[i].seed(seed + i);
+        reset(i);
+    }
+}
+
+void BatchGame::reset(int game)
+{
+    uint64_t *bits = &occupied[(size_t)game*wordsPerGame];
+    for (int w = 0; w < wordsPerGame; w++)
+    {
+        bits[w] = 0;
+    }
+
+    // Start at the same relative position as the windowed game.
+    headX[game] = width*INITIAL_CELL_X/BOARD_WIDTH;
+    headY[game] = height*INITIAL_CELL_Y/BOARD_HEIGHT;
+    direction[game] = EAST;
+    length[game] = 1;
+    score[game] = 0;
+    bodyStart[game] = 0;
+
+    int cell = headY[game]*width + headX[game];
+    bodyCells[(size_t)game*area] = cell;
+    bits[cell >> 6] |= (uint64_t)1 << (cell & 63);
+    placeFruit(game);
+}
+
+void BatchGame::step(const uint8_t *actions)
+{
+    int n = count;
+    int w = width;
+    int h = height;
+
+    // Turn, ignoring requests to reverse. Opposite directions differ
+    // by two, and an Input is its Direction plus one.
+    for (int i = 0; i < n; i++)
+    {
+        int32_t want = (int32_t)actions[i] - 1;
+        int32_t dir = direction[i];
+        bool turn = (want >= 0) & ((want ^ dir) != 2);
+        direction[i] = turn ? want : dir;
+    }
+
+    // Move the head.
+    for (int i = 0; i < n; i++)
+    {
+        int32_t dir = direction[i];
+        nextX[i] = headX[i] + (dir == EAST) - (dir == WEST);
+        nextY[i] = headY[i] + (dir == SOUTH) - (dir == NORTH);
+    }
+
+    // Check walls and fruit.
+    for (int i = 0; i < n; i++)
+    {
+        int32_t x = nextX[i];
+        int32_t y = nextY[i];
+        int32_t wall = (x < 0) | (y < 0) | (x >= w) | (y >= h);
+        hitWall[i] = wall;
+        ate[i] = (x == fruitX[i]) & (y == fruitY[i]) & !wall;
+        reward[i] = ate[i];
+        done[i] = 0;
+    }
+
+    // Update bodies, which live in separate per-game buffers.
+    for (int i = 0; i < n; i++)
+    {
+        if (hitWall[i])
+        {
+            finish(i);
+        }
+        else
+        {
+            advanceBody(i);
+        }
+    }
+}
+
+void BatchGame::advanceBody(int game)
+{
+    int32_t *cells = &bodyCells[(size_t)game*area];
+    uint64_t *bits = &occupied[(size_t)game*wordsPerGame];
+
+    int cell = nextY[game]*width + nextX[game];
+    int tailPos = bodyStart[game] + length[game] - 1;
+    if (tailPos >= area)
+    {
+        tailPos -= area;
+    }
+    int tail = cells[tailPos];
+
+    // Check if snake is in contact with itself. The trailing cell
+    // moves out of the way unless the fruit is eaten.
+    bool covered = (bits[cell >> 6] >> (cell & 63)) & 1;
+    if (covered && (ate[game] || cell != tail))
+    {
+        finish(game);
+        return;
+    }
+
+    if (ate[game])
+    {
+        length[game]++;
+        score[game]++;
+    }
+    else
+    {
+        bits[tail >> 6] &= ~((uint64_t)1 << (tail & 63));
+    }
+
+    int start = bodyStart[game] - 1;
+    if (start < 0)
+    {
+        start += area;
+    }
+    bodyStart[game] = start;
+    cells[start] = cell;
+    bits[cell >> 6] |= (uint64_t)1 << (cell & 63);
+    headX[game] = nextX[game];
+    headY[game] = nextY[game];
+
+    if (ate[game])
+    {
+        placeFruit(game);
+    }
+}
+
+// Record a finished game and start it again.
+void BatchGame::finish(int game)
+{
+    reward[game] = -1;
+    done[game] = 1;
+    finalScore[game] = score[game];
+    reset(game);
+}
+
+// Place the fruit on a random free cell: a few random draws, which
+// almost always succeed, then a scan for the k-th free cell. A full
+// board ends the game.
+void BatchGame::placeFruit(int game)
+{
+    const uint64_t *bits = &occupied[(size_t)game*wordsPerGame];
+    int freeCount = area - length[game];
+    if (freeCount == 0)
+    {
+        finish(game);
+        return;
+    }
+
+    int cell = -1;
+    for (int attempt = 0; attempt < FRUIT_ATTEMPTS && cell < 0; attempt++)
+    {
+        int candidate = randomInt(game, area);
+        if (!((bits[candidate >> 6] >> (candidate & 63)) & 1))
+        {
+            cell = candidate;
+        }
+    }
+    if (cell < 0)
+    {
+        int k = randomInt(game, freeCount);
+        for (cell = 0; cell < area; cell++)
+        {
+            if (!((bits[cell >> 6] >> (cell & 63)) & 1) && k-- == 0)
+            {
+                break;
+            }
+        }
+    }
+    fruitX[game] = cell % width;
+    fruitY[game] = cell / width;
+}
+
+bool BatchGame::covers(int game, Cell cell) const
+{
+    const uint64_t *bits = &occupied[(size_t)game*wordsPerGame];
+    int i = cell.y*width + cell.x;
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+int BatchGame::randomInt(int game, int n)
+{
+    return random[game].below(n);
+}
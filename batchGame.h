@@ -0,0 +1,93 @@
+/*
+ * A batch of independent Snake games advanced together.
+ *
+ * Each per-game field is stored as its own array (structure of
+ * arrays) so the movement, wall and fruit checks run as simple loops
+ * over contiguous data that the compiler can vectorize. Only the body
+ * update, which touches each game's own ring buffer and occupancy
+ * bits, is done game by game. Finished games are reset automatically
+ * so every step() advances every game.
+ */
+#ifndef BATCH_GAME_H
+#define BATCH_GAME_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "gameState.h"
+#include "random.h"
+
+class BatchGame {
+    public:
+        // Advance every game by one tick. actions holds one Input
+        // per game.
+        void step(const uint8_t *actions);
+
+        // Reset a single game to its starting state.
+        void reset(int game);
+
+        int size() const { return count; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // Per-game state, one entry per game.
+        const int32_t *getHeadX() const { return &headX[0]; }
+        const int32_t *getHeadY() const { return &headY[0]; }
+        const int32_t *getDirection() const { return &direction[0]; }
+        const int32_t *getLength() const { return &length[0]; }
+        const int32_t *getFruitX() const { return &fruitX[0]; }
+        const int32_t *getFruitY() const { return &fruitY[0]; }
+        const int32_t *getScore() const { return &score[0]; }
+
+        // Results of the last step: +1 for eating, -1 for dying, and
+        // whether the game finished and was reset. The score a
+        // finished game reached is kept in the final score.
+        const int32_t *getReward() const { return &reward[0]; }
+        const uint8_t *getDone() const { return &done[0]; }
+        const int32_t *getFinalScore() const { return &finalScore[0]; }
+
+        // Whether the snake in the given game covers a cell.
+        bool covers(int game, Cell cell) const;
+
+        // Game i draws fruit positions from seed + i.
+        BatchGame(int count, int width, int height, uint64_t seed);
+
+    private:
+        int count;
+        int width;
+        int height;
+        int area;
+        int wordsPerGame;
+
+        // Per-game state.
+        std::vector<int32_t> headX;
+        std::vector<int32_t> headY;
+        std::vector<int32_t> direction;
+        std::vector<int32_t> length;
+        std::vector<int32_t> fruitX;
+        std::vector<int32_t> fruitY;
+        std::vector<int32_t> score;
+        std::vector<int32_t> bodyStart;
+        std::vector<Random> random;
+
+        // Per-step scratch and results.
+        std::vector<int32_t> nextX;
+        std::vector<int32_t> nextY;
+        std::vector<int32_t> hitWall;
+        std::vector<int32_t> ate;
+        std::vector<int32_t> reward;
+        std::vector<uint8_t> done;
+        std::vector<int32_t> finalScore;
+
+        // Body ring buffers of cell indices, area entries per game,
+        // and occupancy bits, wordsPerGame words per game.
+        std::vector<int32_t> bodyCells;
+        std::vector<uint64_t> occupied;
+
+        void advanceBody(int game);
+        void finish(int game);
+        void placeFruit(int game);
+        int randomInt(int game, int n);
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * A game on a board whose size is fixed at compile time.
+ *
+ * FixedGame<WIDTH, HEIGHT> plays exactly the same game as a GameState
+ * of that size with the same seed, move for move and fruit for fruit,
+ * but the board size is a template constant. Bounds checks and cell
+ * indexing fold to constants, occupancy is a bitboard of a few words
+ * that stays in cache (two words on a 10x10 board, seven on 20x20,
+ * 24 on the default 40x37), and the body is a fixed ring of cell
+ * indexes, so a game allocates nothing.
+ *
+ * It offers the part of the GameState interface that the policies
+ * read, so they play either one. withBoard() picks the specialization
+ * for a board size, falling back to GameState for the sizes that have
+ * none.
+ *
+ * Turning and moving share turn() and neighbour() with GameState, but
+ * the collision and fruit rules here repeat those in GameState::step().
+ * "make check" plays every specialization against GameState tick by
+ * tick, so a size added to withBoard() should be added to runCheck()
+ * in snakeSim.cpp too.
+ */
+#ifndef FIXED_GAME_H
+#define FIXED_GAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gameState.h"
+#include "random.h"
+
+// Smallest power of two of at least n.
+constexpr int ringCapacity(int n, int capacity = 1)
+{
+    return capacity >= n ? capacity : ringCapacity(n, capacity*2);
+}
+
+template <int WIDTH, int HEIGHT>
+class FixedGame {
+    public:
+        static const int AREA = WIDTH*HEIGHT;
+        static const int WORDS = (AREA + 63)/64;
+
+        static_assert(AREA <= 65536, "body cells are stored as 16-bit indexes");
+
+        /*
+         * The body as a ring buffer of cell indexes, head first.
+         */
+        class Body {
+            public:
+                size_t size() const { return length; }
+
+                Cell operator[](size_t i) const
+                {
+                    return toCell(cells[(headIndex + i) & MASK]);
+                }
+
+                Cell front() const { return toCell(cells[headIndex]); }
+                Cell back() const { return (*this)[length - 1]; }
+
+            private:
+                friend class FixedGame;
+
+                static const int CAPACITY = ringCapacity(AREA);
+                static const int MASK = CAPACITY - 1;
+
+                uint16_t cells[CAPACITY];
+                unsigned headIndex;
+                unsigned length;
+        };
+
+        // Advance the game by one cell in the current direction.
+        void step(Input input);
+
+        // Reinitialize the snake, fruit and score.
+        void restart();
+
+        // Reinitialize, drawing fruit from a new seed.
+        void restart(uint64_t seed)
+        {
+            random.seed(seed);
+            restart();
+        }
+
+        int getWidth() const { return WIDTH; }
+        int getHeight() const { return HEIGHT; }
+
+        // Whether a cell lies on the board. Negative coordinates wrap
+        // to large unsigned ones, so this is two compares.
+        bool contains(Cell cell) const
+        {
+            return (unsigned)cell.x < (unsigned)WIDTH && (unsigned)cell.y < (unsigned)HEIGHT;
+        }
+
+        bool isAlive() const { return alive; }
+        DeathCause getDeathCause() const { return death; }
+        int getScore() const { return score; }
+        Direction getDirection() const { return direction; }
+        Cell getFruit() const { return fruit; }
+
+        // Body cells ordered from head to tail.
+        const Body &getBody() const { return body; }
+
+        // Whether the snake covers the given cell.
+        bool covers(Cell cell) const { return test(indexOf(cell)); }
+
+        // Each game draws fruit positions from its own seed.
+        FixedGame(uint64_t seed = 1): random(seed)
+        {
+            restart();
+        }
+
+    private:
+        Body body;
+        uint64_t occupied[WORDS];
+        Direction direction;
+        Cell fruit;
+        int score;
+        bool alive;
+        DeathCause death;
+        Random random;
+
+        static int indexOf(Cell cell)
+        {
+            return cell.y*WIDTH + cell.x;
+        }
+
+        static Cell toCell(int i)
+        {
+            Cell cell = {i % WIDTH, i / WIDTH};
+            return cell;
+        }
+
+        bool test(int i) const
+        {
+            return (occupied[i >> 6] >> (i & 63)) & 1;
+        }
+
+        void occupy(int i)
+        {
+            occupied[i >> 6] |= (uint64_t)1 << (i & 63);
+        }
+
+        void vacate(int i)
+        {
+            occupied[i >> 6] &= ~((uint64_t)1 << (i & 63));
+        }
+
+        void placeFruit();
+};
+
+template <int WIDTH, int HEIGHT>
+void FixedGame<WIDTH, HEIGHT>::restart()
+{
+    // The same start as GameState::restart() on this board.
+    Cell start = {WIDTH*INITIAL_CELL_X/BOARD_WIDTH, HEIGHT*INITIAL_CELL_Y/BOARD_HEIGHT};
+
+    for (int w = 0; w < WORDS; w++)
+    {
+        occupied[w] = 0;
+    }
+    body.headIndex = 0;
+    body.cells[0] = indexOf(start);
+    body.length = 1;
+    occupy(indexOf(start));
+    direction = EAST;
+    score = 0;
+    alive = true;
+    death = DEATH_NONE;
+    placeFruit();
+}
+
+template <int WIDTH, int HEIGHT>
+void FixedGame<WIDTH, HEIGHT>::step(Input input)
+{
+    if (!alive)
+    {
+        return;
+    }
+
+    direction = turn(direction, input);
+    Cell head = neighbour(body.front(), direction);
+
+    // Check if snake is in contact with the wall.
+    if (!contains(head))
+    {
+        alive = false;
+        death = DEATH_WALL;
+        return;
+    }
+
+    // Check if snake is in contact with itself. The trailing cell
+    // moves out of the way unless the fruit is eaten.
+    int next = indexOf(head);
+    bool ate = (head.x == fruit.x && head.y == fruit.y);
+    int tail = body.cells[(body.headIndex + body.length - 1) & Body::MASK];
+    if (test(next) && (ate || next != tail))
+    {
+        alive = false;
+        death = DEATH_SELF;
+        return;
+    }
+
+    if (!ate)
+    {
+        vacate(tail);
+        body.length--;
+    }
+    body.headIndex = (body.headIndex - 1) & Body::MASK;
+    body.cells[body.headIndex] = next;
+    body.length++;
+    occupy(next);
+
+    if (ate)
+    {
+        score++;
+        placeFruit();
+    }
+}
+
+// Place the fruit on the k-th free cell in board order, drawing k the
+// way an indexed GameState does so both place the same fruit. The
+// game ends when the snake fills the whole board.
+template <int WIDTH, int HEIGHT>
+void FixedGame<WIDTH, HEIGHT>::placeFruit()
+{
+    if ((int)body.length == AREA)
+    {
+        fruit.x = -1;
+        fruit.y = -1;
+        alive = false;
+        death = DEATH_BOARD_FULL;
+        return;
+    }
+
+    uint32_t k = random.below(AREA - body.length);
+    for (int w = 0; ; w++)
+    {
+        uint64_t free = ~occupied[w];
+        if (w == WORDS - 1 && AREA % 64 != 0)
+        {
+            free &= ((uint64_t)1 << (AREA % 64)) - 1;
+        }
+        uint32_t count = __builtin_popcountll(free);
+        if (k < count)
+        {
+            for (; k > 0; k--)
+            {
+                free &= free - 1;
+            }
+            fruit = toCell(w*64 + __builtin_ctzll(free));
+            return;
+        }
+        k -= count;
+    }
+}
+
+/*
+ * Call play(game) with a new game on a board of the given size and
+ * seed: a FixedGame for 10x10, 20x20 and the default board, and a
+ * GameState for any other size, or for every size when generic is
+ * set.
+ */
+template <class Play>
+void withBoard(int width, int height, uint64_t seed, bool generic, Play play)
+{
+    if (!generic && width == 10 && height == 10)
+    {
+        FixedGame<10, 10> game(seed);
+        play(game);
+    }
+    else if (!generic && width == 20 && height == 20)
+    {
+        FixedGame<20, 20> game(seed);
+        play(game);
+    }
+    else if (!generic && width == BOARD_WIDTH && height == BOARD_HEIGHT)
+    {
+        FixedGame<BOARD_WIDTH, BOARD_HEIGHT> game(seed);
+        play(game);
+    }
+    else
+    {
+        GameState game(seed, width, height);
+        play(game);
+    }
+}
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Client-side framebuffer for the board. See frameBuffer.h.
+ */
+
+// Import header files.
+#include <cstdlib>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "frameBuffer.h"
+
+using namespace std;
+
+// Set when attaching the shared memory fails on the server, such as
+// over a remote connection.
+static bool shmFailed;
+
+static int shmErrorHandler(Display *, XErrorEvent *)
+{
+    shmFailed = true;
+    return 0;
+}
+
+bool FrameBuffer::create(Display * display, int screenNumber, int width, int height)
+{
+    destroy();
+    this->display = display;
+    this->width = width;
+    this->height = height;
+    foreground = BlackPixel(display, screenNumber);
+    background = WhitePixel(display, screenNumber);
+
+    Visual * visual = DefaultVisual(display, screenNumber);
+    int depth = DefaultDepth(display, screenNumber);
+    if (!createShared(visual, depth))
+    {
+        char * data = (char *)malloc((size_t)width*height*4);
+        image = XCreateImage(display, visual, depth, ZPixmap, 0, data,
+                             width, height, 32, 0);
+        if (image == NULL)
+        {
+            free(data);
+        }
+    }
+
+    if (image == NULL || image->bits_per_pixel != 32)
+    {
+        destroy();
+        return false;
+    }
+    clear();
+    return true;
+}
+
+// Create the image in a shared memory segment the server attaches
+// to. Returns false if the extension or the attach is unavailable.
+bool FrameBuffer::createShared(Visual * visual, int depth)
+{
+    if (!XShmQueryExtension(display))
+    {
+        return false;
+    }
+    image = XShmCreateImage(display, visual, depth, ZPixmap, NULL, &shmInfo, width, height);
+    if (image == NULL)
+    {
+        return false;
+    }
+
+    shmInfo.shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line*height, IPC_CREAT | 0600);
+    if (shmInfo.shmid < 0)
+    {
+        XDestroyImage(image);
+        image = NULL;
+        return false;
+    }
+    shmInfo.shmaddr = (char *)shmat(shmInfo.shmid, NULL, 0);
+    if (shmInfo.shmaddr == (char *)-1)
+    {
+        shmctl(shmInfo.shmid, IPC_RMID, NULL);
+        XDestroyImage(image);
+        image = NULL;
+        return false;
+    }
+    image->data = shmInfo.shmaddr;
+    shmInfo.readOnly = False;
+
+    // The attach is only known to have worked once the server has
+    // processed it.
+    shmFailed = false;
+    XErrorHandler previous = XSetErrorHandler(shmErrorHandler);
+    XShmAttach(display, &shmInfo);
+    XSync(display, False);
+    XSetErrorHandler(previous);
+
+    // Mark the segment for removal now, so it goes away with the
+    // process and the server however they exit.
+    shmctl(shmInfo.shmid, IPC_RMID, NULL);
+    if (shmFailed)
+    {
+        shmdt(shmInfo.shmaddr);
+        image->data = NULL;
+        XDestroyImage(image);
+        image = NULL;
+        return false;
+    }
+    shared = true;
+    return true;
+}
+
+void FrameBuffer::destroy()
+{
+    if (image == NULL)
+    {
+        return;
+    }
+    if (shared)
+    {
+        XShmDetach(display, &shmInfo);
+        XSync(display, False);
+        shmdt(shmInfo.shmaddr);
+        image->data = NULL;
+    }
+    XDestroyImage(image);
+    image = NULL;
+    shared = false;
+    pending = false;
+}
+
+void FrameBuffer::clear()
+{
+    fillRect(0, 0, width, height, false);
+}
+
+void FrameBuffer::fillRect(int x, int y, int w, int h, bool on)
+{
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > width)
+    {
+        w = width - x;
+    }
+    if (y + h > height)
+    {
+        h = height - y;
+    }
+    if (w <= 0 || h <= 0)
+    {
+        return;
+    }
+
+    waitForServer();
+    uint32_t pixel = on ? foreground : background;
+    for (int row = y; row < y + h; row++)
+    {
+        fillSpan((uint32_t *)(image->data + (size_t)row*image->bytes_per_line) + x, w, pixel);
+    }
+}
+
+void FrameBuffer::put(Drawable drawable, GC gc, int x, int y, int w, int h)
+{
+    if (shared)
+    {
+        XShmPutImage(display, drawable, gc, image, x, y, x, y, w, h, False);
+        pending = true;
+    }
+    else
+    {
+        XPutImage(display, drawable, gc, image, x, y, x, y, w, h);
+    }
+}
+
+// The server reads a shared image some time after the request is
+// sent, so wait for it before drawing over one that was put.
+void FrameBuffer::waitForServer()
+{
+    if (pending)
+    {
+        XSync(display, False);
+        pending = false;
+    }
+}
+
+// Fill a row of pixels, four at a time where SSE2 is available.
+void FrameBuffer::fillSpan(uint32_t * row, int count, uint32_t pixel)
+{
+    int i = 0;
+#ifdef __SSE2__
+    __m128i pixels = _mm_set1_epi32(pixel);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i *)(row + i), pixels);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        row[i] = pixel;
+    }
+}
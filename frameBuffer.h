@@ -0,0 +1,74 @@
+/*
+ * A client-side framebuffer the board is rasterized into, as an
+ * alternative to drawing each cell with Xlib primitives.
+ *
+ * Cells are filled into an XImage in memory a row span at a time,
+ * and the image is presented to a drawable with one request. When
+ * the MIT-SHM extension is available the image lives in memory
+ * shared with the X server, so presenting it sends no pixels over
+ * the connection; otherwise it falls back to XPutImage. Only visuals
+ * with 32-bit pixels are supported.
+ */
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <stdint.h>
+
+// Header files for X functions.
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+
+// Ways of drawing the board.
+enum RendererType {PRIMITIVE_RENDERER, FRAMEBUFFER_RENDERER};
+
+class FrameBuffer {
+    public:
+        // Create an image of the given size in pixels for the default
+        // screen's visual. Returns false if its pixels are not 32 bits.
+        bool create(Display * display, int screenNumber, int width, int height);
+
+        // Release the image and any shared memory, while the display
+        // is still open.
+        void destroy();
+
+        // Whether the image is presented through shared memory.
+        bool isShared() const { return shared; }
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // Fill the whole image with the background.
+        void clear();
+
+        // Fill a rectangle, clipped to the image, with the foreground
+        // when on is set and the background otherwise.
+        void fillRect(int x, int y, int w, int h, bool on);
+
+        // Copy a rectangle of the image to the same place in a
+        // drawable.
+        void put(Drawable drawable, GC gc, int x, int y, int w, int h);
+
+        FrameBuffer(): display(NULL), image(NULL), shared(false), pending(false),
+                       width(0), height(0)
+        {
+        }
+
+    private:
+        Display * display;
+        XImage * image;
+        XShmSegmentInfo shmInfo;
+        bool shared;
+        // Whether the server may still be reading the shared image.
+        bool pending;
+        int width;
+        int height;
+        uint32_t foreground;
+        uint32_t background;
+
+        bool createShared(Visual * visual, int depth);
+        void waitForServer();
+        void fillSpan(uint32_t * row, int count, uint32_t pixel);
+};
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Frame output on an encoder thread. See frameEncoder.h.
+ */
+
+// Import header files.
+#include <cstring>
+
+#include "frameEncoder.h"
+#include "tracer.h"
+
+using namespace std;
+
+bool FrameEncoder::open(FrameFormat format, const string &path, int width, int height,
+                        unsigned long rateNumerator, unsigned long rateDenominator)
+{
+    this->format = format;
+    this->path = path;
+    failed = false;
+    frames = 0;
+
+    if (format == Y4M_STREAM)
+    {
+        out = (path == "-") ? stdout : fopen(path.c_str(), "wb");
+        if (out == NULL)
+        {
+            return false;
+        }
+        fprintf(out, "YUV4MPEG2 W%d H%d F%lu:%lu Ip A1:1 C444\n",
+                width, height, rateNumerator, rateDenominator);
+        planes.resize((size_t)width*height*3);
+    }
+
+    pool.resize(POOL_SIZE);
+    for (int i = 0; i < POOL_SIZE; i++)
+    {
+        pool[i].resize(width, height);
+        spare.push(&pool[i]);
+    }
+    worker = thread(&FrameEncoder::run, this);
+    return true;
+}
+
+RgbImage &FrameEncoder::nextFrame()
+{
+    current = NULL;
+    if (!spare.pop(current))
+    {
+        TraceSpan span("wait for encoder");
+        unique_lock<mutex> guard(lock);
+        while (!spare.pop(current))
+        {
+            signal.wait(guard);
+        }
+    }
+    return *current;
+}
+
+void FrameEncoder::submit()
+{
+    ready.push(current);
+    current = NULL;
+    frames++;
+    notify();
+}
+
+bool FrameEncoder::close()
+{
+    if (!worker.joinable())
+    {
+        return !failed;
+    }
+    ready.push(NULL);
+    notify();
+    worker.join();
+
+    if (out != NULL)
+    {
+        failed |= (fflush(out) != 0);
+        if (out != stdout)
+        {
+            failed |= (fclose(out) != 0);
+        }
+        out = NULL;
+    }
+    return !failed;
+}
+
+// Wake the other thread if it is waiting. Taking the lock makes sure
+// it is either still before its check of the queue or already asleep.
+void FrameEncoder::notify()
+{
+    {
+        lock_guard<mutex> guard(lock);
+    }
+    signal.notify_all();
+}
+
+void FrameEncoder::run()
+{
+    traceThreadName("encoder");
+    long number = 0;
+    while (true)
+    {
+        RgbImage * image = NULL;
+        if (!ready.pop(image))
+        {
+            unique_lock<mutex> guard(lock);
+            while (!ready.pop(image))
+            {
+                signal.wait(guard);
+            }
+        }
+        if (image == NULL)
+        {
+            return;
+        }
+
+        {
+            TraceSpan span("encode");
+            writeFrame(*image, number++);
+        }
+        spare.push(image);
+        notify();
+    }
+}
+
+void FrameEncoder::writeFrame(const RgbImage &image, long number)
+{
+    if (failed)
+    {
+        return;
+    }
+    if (format == PPM_SEQUENCE)
+    {
+        writePpm(image, number);
+    }
+    else
+    {
+        writeY4m(image);
+    }
+}
+
+void FrameEncoder::writePpm(const RgbImage &image, long number)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%06ld.ppm", number);
+    FILE * file = fopen((path + name).c_str(), "wb");
+    if (file == NULL)
+    {
+        failed = true;
+        return;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", image.getWidth(), image.getHeight());
+    failed |= (fwrite(image.data(), 1, image.size(), file) != image.size());
+    failed |= (fclose(file) != 0);
+}
+
+// Convert to BT.601 studio-range Y, Cb and Cr planes at full
+// resolution and write them after a frame header. Frames are runs of
+// a few colours, so each pixel's colour is only converted when it
+// differs from the last.
+void FrameEncoder::writeY4m(const RgbImage &image)
+{
+    size_t count = (size_t)image.getWidth()*image.getHeight();
+    const uint8_t * rgb = image.data();
+    uint8_t * y = &planes[0];
+    uint8_t * u = y + count;
+    uint8_t * v = u + count;
+    int last = -1;
+    uint8_t lastY = 0, lastU = 0, lastV = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        int r = rgb[i*3];
+        int g = rgb[i*3 + 1];
+        int b = rgb[i*3 + 2];
+        int colour = (r << 16) | (g << 8) | b;
+        if (colour != last)
+        {
+            last = colour;
+            lastY = ((66*r + 129*g + 25*b + 128) >> 8) + 16;
+            lastU = ((-38*r - 74*g + 112*b + 128) >> 8) + 128;
+            lastV = ((112*r - 94*g - 18*b + 128) >> 8) + 128;
+        }
+        y[i] = lastY;
+        u[i] = lastU;
+        v[i] = lastV;
+    }
+
+    fputs("FRAME\n", out);
+    failed |= (fwrite(&planes[0], 1, planes.size(), out) != planes.size());
+}
@@ -0,0 +1,88 @@
+/*
+ * Writes rendered frames out on a thread of its own, so drawing the
+ * next frame overlaps encoding and writing the last.
+ *
+ * Frames are drawn into a small pool of images. The drawing thread
+ * takes a free image, fills it and submits it; the encoder thread
+ * writes it and hands it back. Both hand-offs go through lock-free
+ * queues, and a side only sleeps when the other has fallen behind.
+ *
+ * Output is a numbered sequence of binary PPM images, or a YUV4MPEG2
+ * (y4m) stream of 4:4:4 frames that video tools read directly.
+ */
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+
+#include "offscreenView.h"
+#include "spscQueue.h"
+
+enum FrameFormat {PPM_SEQUENCE, Y4M_STREAM};
+
+class FrameEncoder {
+    public:
+        // Start writing frames of the given size. For PPM_SEQUENCE
+        // path is a prefix the frame number and ".ppm" are added to;
+        // for Y4M_STREAM it is a file, or "-" for standard output.
+        // The frame rate is a fraction of frames per second.
+        bool open(FrameFormat format, const std::string &path, int width, int height,
+                  unsigned long rateNumerator, unsigned long rateDenominator);
+
+        // A free image to draw the next frame into, waiting for the
+        // encoder to hand one back if they are all in use.
+        RgbImage &nextFrame();
+
+        // Queue the image from nextFrame() to be written.
+        void submit();
+
+        // Write every queued frame and stop. Returns false if any
+        // write failed. Does nothing more if already closed.
+        bool close();
+
+        long getFrameCount() const { return frames; }
+
+        FrameEncoder(): ready(POOL_SIZE + 1), spare(POOL_SIZE), current(NULL),
+                        out(NULL), failed(false), frames(0)
+        {
+        }
+
+        ~FrameEncoder()
+        {
+            close();
+        }
+
+    private:
+        static const int POOL_SIZE = 4;
+
+        // Images waiting to be written, ending with NULL on close, and
+        // images free to draw into.
+        std::vector<RgbImage> pool;
+        SpscQueue<RgbImage *> ready;
+        SpscQueue<RgbImage *> spare;
+        RgbImage * current;
+        std::mutex lock;
+        std::condition_variable signal;
+        std::thread worker;
+
+        FrameFormat format;
+        std::string path;
+        FILE * out;
+        bool failed;
+        long frames;
+        // Colour planes of a y4m frame, reused between frames.
+        std::vector<uint8_t> planes;
+
+        void run();
+        void writeFrame(const RgbImage &image, long number);
+        void writePpm(const RgbImage &image, long number);
+        void writeY4m(const RgbImage &image);
+        void notify();
+};
+
+#endif
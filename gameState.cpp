@@ -0,0 +1,240 @@
+/*
+ * Headless game state for Snake. See gameState.h.
+ */
+
+// Import header files.
+#include <stdio.h>
+
+#include "gameState.h"
+#include "tracer.h"
+
+using namespace std;
+
+bool parseBoardSize(const char * text, int &width, int &height)
+{
+    int w, h;
+    char end;
+    if (sscanf(text, "%dx%d%c", &w, &h, &end) != 2
+        || w < 1 || h < 1 || w > MAX_BOARD_SIDE || h > MAX_BOARD_SIDE)
+    {
+        return false;
+    }
+    width = w;
+    height = h;
+    return true;
+}
+
+GameState::GameState(uint64_t seed, int width, int height): freeCells(0, 0), random(seed)
+{
+    // A step vacates the tail, occupies the head and moves the fruit.
+    changed.reserve(3);
+    setBoard(width, height);
+    restart();
+}
+
+void GameState::restart()
+{
+    // Start the same fraction of the way across any board as on the
+    // default one.
+    Cell start = {(int)((long)width*INITIAL_CELL_X/BOARD_WIDTH),
+                  (int)((long)height*INITIAL_CELL_Y/BOARD_HEIGHT)};
+
+    body.clear();
+    changed.clear();
+    occupied.reset();
+    setBoard(width, height);
+    body.push_front(start);
+    occupy(start);
+    direction = EAST;
+    score = 0;
+    alive = true;
+    death = DEATH_NONE;
+    placeFruit();
+}
+
+void GameState::restart(uint64_t seed)
+{
+    random.seed(seed);
+    restart();
+}
+
+void GameState::resize(int width, int height)
+{
+    setBoard(width, height);
+    restart();
+}
+
+void GameState::save(SavedGame &saved) const
+{
+    saved.width = width;
+    saved.height = height;
+    saved.body.resize(body.size());
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        saved.body[i] = body[i];
+    }
+    saved.direction = direction;
+    saved.fruit = fruit;
+    saved.score = score;
+    saved.alive = alive;
+    saved.death = death;
+    saved.randomState = random.getState();
+}
+
+void GameState::load(const SavedGame &saved)
+{
+    body.clear();
+    occupied.reset();
+    setBoard(saved.width, saved.height);
+
+    // Rebuild from the tail so the head ends up at the front.
+    for (size_t i = saved.body.size(); i > 0; i--)
+    {
+        body.push_front(saved.body[i - 1]);
+        occupy(saved.body[i - 1]);
+    }
+    changed.clear();
+    direction = saved.direction;
+    fruit = saved.fruit;
+    score = saved.score;
+    alive = saved.alive;
+    death = saved.death;
+    random.setState(saved.randomState);
+}
+
+void GameState::step(Input input)
+{
+    changed.clear();
+    if (!alive)
+    {
+        return;
+    }
+
+    direction = turn(direction, input);
+    Cell head = neighbour(body.front(), direction);
+
+    // Check if snake is in contact with the wall.
+    if (!contains(head))
+    {
+        alive = false;
+        death = DEATH_WALL;
+        return;
+    }
+
+    // Check if snake is in contact with itself. The trailing cell
+    // moves out of the way unless the fruit is eaten.
+    bool ate = (head.x == fruit.x && head.y == fruit.y);
+    Cell tail = body.back();
+    bool intoTail = (!ate && head.x == tail.x && head.y == tail.y);
+    if (occupied.test(head) && !intoTail)
+    {
+        alive = false;
+        death = DEATH_SELF;
+        return;
+    }
+
+    if (!ate)
+    {
+        vacate(tail);
+        body.pop_back();
+    }
+    body.push_front(head);
+    occupy(head);
+
+    if (ate)
+    {
+        score++;
+        placeFruit();
+    }
+}
+
+void GameState::occupy(Cell cell)
+{
+    occupied.set(cell);
+    if (indexed)
+    {
+        freeCells.remove(cell);
+    }
+    changed.push_back(cell);
+}
+
+void GameState::vacate(Cell cell)
+{
+    occupied.clear(cell);
+    if (indexed)
+    {
+        freeCells.add(cell);
+    }
+    changed.push_back(cell);
+}
+
+// Place the fruit at a random cell not covered by the snake. The
+// game ends when the snake fills the whole board.
+void GameState::placeFruit()
+{
+    TraceSpan span("fruit");
+    long area = (long)width*height;
+    if ((long)body.size() == area)
+    {
+        fruit.x = -1;
+        fruit.y = -1;
+        alive = false;
+        death = DEATH_BOARD_FULL;
+        return;
+    }
+
+    // Whether the index is used depends only on the board and the
+    // snake's length, so a restored game places fruit the same way.
+    if (!indexed && (long)body.size()*2 > area)
+    {
+        buildIndex();
+    }
+    if (indexed)
+    {
+        fruit = freeCells.at(randomInt(freeCells.size()));
+    }
+    else
+    {
+        // At least half the board is free, so this takes fewer than
+        // two draws on average.
+        do
+        {
+            fruit.x = random.below(width);
+            fruit.y = random.below(height);
+        } while (occupied.test(fruit));
+    }
+    changed.push_back(fruit);
+}
+
+// Use a board of the given size with every cell free, indexing the
+// free cells if the board is small enough.
+void GameState::setBoard(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    indexed = ((long)width*height <= DENSE_BOARD_AREA);
+    if (indexed)
+    {
+        freeCells.resize(width, height);
+    }
+    else
+    {
+        freeCells.resize(0, 0);
+    }
+}
+
+// Start indexing the free cells of a large board.
+void GameState::buildIndex()
+{
+    freeCells.resize(width, height);
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        freeCells.remove(body[i]);
+    }
+    indexed = true;
+}
+
+int GameState::randomInt(int n)
+{
+    return random.below(n);
+}
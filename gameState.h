@@ -0,0 +1,634 @@
+/*
+ * Headless game state for Snake.
+ *
+ * The board, snake body, fruit, score and random number generation
+ * live here with no dependency on X11, so a game can be advanced one
+ * tick at a time with step() without opening a display. The X
+ * front-end in snakeGame.cpp only reads this state to draw it.
+ */
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "random.h"
+
+// Board parameters, in cells: the default board, which fills the
+// game window, and the largest side a board may have.
+const int BOARD_WIDTH = 40;
+const int BOARD_HEIGHT = 37;
+const int INITIAL_CELL_X = 15;
+const int INITIAL_CELL_Y = 15;
+const int MAX_BOARD_SIDE = 65536;
+
+// Boards of up to this many cells index their free cells from the
+// start. Larger ones find a free cell for the fruit by drawing until
+// they hit one, and only build the index once the snake covers half
+// the board, when it is no larger than the snake itself.
+const long DENSE_BOARD_AREA = 1 << 20;
+
+// Snake speed settings, in ticks (cells moved) per second.
+const int SPEED_COUNT = 5;
+const int DEFAULT_SPEED = 2;
+const double speedArrray[SPEED_COUNT] = {5, 10, 15, 20, 25};
+
+/*
+ * Snake direction enum.
+ */
+enum Direction {NORTH, EAST, SOUTH, WEST};
+
+/*
+ * Input applied at the start of a tick. INPUT_NONE keeps the
+ * current direction.
+ */
+enum Input {INPUT_NONE, INPUT_NORTH, INPUT_EAST, INPUT_SOUTH, INPUT_WEST};
+
+/*
+ * A board cell, in cell coordinates.
+ */
+struct Cell {
+    int x;
+    int y;
+};
+
+// Index of a cell in row-major order on a board of the given width,
+// by default the default board's, and back.
+inline long cellIndex(Cell cell, int width = BOARD_WIDTH)
+{
+    return (long)cell.y*width + cell.x;
+}
+
+inline Cell indexCell(long i, int width = BOARD_WIDTH)
+{
+    Cell cell = {(int)(i % width), (int)(i / width)};
+    return cell;
+}
+
+// The cell one step from a cell in a direction, which may be off
+// the board.
+inline Cell neighbour(Cell cell, Direction direction)
+{
+    switch (direction)
+    {
+        case NORTH: cell.y--; break;
+        case EAST:  cell.x++; break;
+        case SOUTH: cell.y++; break;
+        case WEST:  cell.x--; break;
+    }
+    return cell;
+}
+
+// The direction a snake heading one way takes on an input, ignoring
+// requests to reverse into the body.
+inline Direction turn(Direction direction, Input input)
+{
+    switch (input)
+    {
+        case INPUT_NORTH:
+            if (direction != SOUTH) direction = NORTH;
+            break;
+        case INPUT_EAST:
+            if (direction != WEST) direction = EAST;
+            break;
+        case INPUT_SOUTH:
+            if (direction != NORTH) direction = SOUTH;
+            break;
+        case INPUT_WEST:
+            if (direction != EAST) direction = WEST;
+            break;
+        case INPUT_NONE:
+            break;
+    }
+    return direction;
+}
+
+// The direction of a step between neighbouring cells.
+inline Direction stepDirection(Cell from, Cell to)
+{
+    if (to.y < from.y) return NORTH;
+    if (to.x > from.x) return EAST;
+    if (to.y > from.y) return SOUTH;
+    return WEST;
+}
+
+// Read a board size written as WIDTHxHEIGHT. Returns false unless
+// both sides are between 1 and MAX_BOARD_SIDE.
+bool parseBoardSize(const char * text, int &width, int &height);
+
+/*
+ * The snake body as a ring buffer of cells, head first. Storage is
+ * preallocated and only grows, doubling, when the snake eats with
+ * the buffer full, so a steady-state move does no allocation.
+ */
+class SnakeBody {
+    public:
+        // Number of cells in the body.
+        size_t size() const { return length; }
+
+        // Cell i counted from the head.
+        const Cell &operator[](size_t i) const
+        {
+            return cells[(headIndex + i) & mask];
+        }
+
+        const Cell &front() const { return cells[headIndex]; }
+        const Cell &back() const { return (*this)[length - 1]; }
+
+        void push_front(Cell cell)
+        {
+            if (length == cells.size())
+            {
+                grow();
+            }
+            headIndex = (headIndex - 1) & mask;
+            cells[headIndex] = cell;
+            length++;
+        }
+
+        void pop_back()
+        {
+            length--;
+        }
+
+        void clear()
+        {
+            headIndex = 0;
+            length = 0;
+        }
+
+        SnakeBody(): cells(INITIAL_BODY_CAPACITY), headIndex(0), length(0),
+                     mask(INITIAL_BODY_CAPACITY - 1)
+        {
+        }
+
+    private:
+        static const size_t INITIAL_BODY_CAPACITY = 64;
+
+        // Capacity is kept a power of two so wrapping is a mask.
+        std::vector<Cell> cells;
+        size_t headIndex;
+        size_t length;
+        size_t mask;
+
+        void grow()
+        {
+            std::vector<Cell> larger(cells.size()*2);
+            for (size_t i = 0; i < length; i++)
+            {
+                larger[i] = (*this)[i];
+            }
+            cells.swap(larger);
+            headIndex = 0;
+            mask = cells.size() - 1;
+        }
+};
+
+/*
+ * One bit per board cell, set while the snake covers the cell.
+ * Kept up to date as cells are added at the head and removed at
+ * the tail so collision checks do not walk the body.
+ *
+ * The bits are kept in 8x8 tiles, and only tiles the snake is on are
+ * stored, in an open-addressing hash table keyed by tile position.
+ * Memory follows the length of the snake rather than the area of the
+ * board, and a test is usually a single probe.
+ */
+class OccupancyGrid {
+    public:
+        bool test(Cell cell) const
+        {
+            uint64_t key = tileKey(cell);
+            for (size_t i = home(key); ; i = (i + 1) & mask)
+            {
+                if (slots[i].key == key)
+                {
+                    return (slots[i].bits >> tileBit(cell)) & 1;
+                }
+                if (slots[i].key == EMPTY)
+                {
+                    return false;
+                }
+            }
+        }
+
+        void set(Cell cell)
+        {
+            uint64_t key = tileKey(cell);
+            size_t i = home(key);
+            while (slots[i].key != key && slots[i].key != EMPTY)
+            {
+                i = (i + 1) & mask;
+            }
+            if (slots[i].key == EMPTY)
+            {
+                // Keep the table at most half full.
+                if ((used + 1)*2 > slots.size())
+                {
+                    grow();
+                    set(cell);
+                    return;
+                }
+                slots[i].key = key;
+                slots[i].bits = 0;
+                used++;
+            }
+            slots[i].bits |= (uint64_t)1 << tileBit(cell);
+        }
+
+        void clear(Cell cell)
+        {
+            uint64_t key = tileKey(cell);
+            size_t i = home(key);
+            while (slots[i].key != key)
+            {
+                if (slots[i].key == EMPTY)
+                {
+                    return;
+                }
+                i = (i + 1) & mask;
+            }
+            slots[i].bits &= ~((uint64_t)1 << tileBit(cell));
+            if (slots[i].bits == 0)
+            {
+                erase(i);
+            }
+        }
+
+        void reset()
+        {
+            Slot empty = {EMPTY, 0};
+            slots.assign(slots.size(), empty);
+            used = 0;
+        }
+
+        OccupancyGrid(): mask(MIN_SLOTS - 1), used(0)
+        {
+            Slot empty = {EMPTY, 0};
+            slots.assign(MIN_SLOTS, empty);
+        }
+
+    private:
+        struct Slot {
+            uint64_t key;
+            uint64_t bits;
+        };
+
+        static const uint64_t EMPTY = ~(uint64_t)0;
+        static const size_t MIN_SLOTS = 64;
+
+        // Capacity is kept a power of two so wrapping is a mask.
+        std::vector<Slot> slots;
+        size_t mask;
+        size_t used;
+
+        static uint64_t tileKey(Cell cell)
+        {
+            return ((uint64_t)(uint32_t)(cell.y >> 3) << 32) | (uint32_t)(cell.x >> 3);
+        }
+
+        static int tileBit(Cell cell)
+        {
+            return (cell.y & 7)*8 + (cell.x & 7);
+        }
+
+        size_t home(uint64_t key) const
+        {
+            return ((key*0x9e3779b97f4a7c15ULL) >> 32) & mask;
+        }
+
+        // Remove slot i, moving later slots of the same run back so
+        // every key stays reachable from its home slot.
+        void erase(size_t i)
+        {
+            size_t next = (i + 1) & mask;
+            while (slots[next].key != EMPTY)
+            {
+                size_t want = home(slots[next].key);
+                if (((next - want) & mask) >= ((next - i) & mask))
+                {
+                    slots[i] = slots[next];
+                    i = next;
+                }
+                next = (next + 1) & mask;
+            }
+            slots[i].key = EMPTY;
+            used--;
+        }
+
+        void grow()
+        {
+            std::vector<Slot> old;
+            old.swap(slots);
+            Slot empty = {EMPTY, 0};
+            slots.assign(old.size()*2, empty);
+            mask = slots.size() - 1;
+            for (size_t i = 0; i < old.size(); i++)
+            {
+                if (old[i].key != EMPTY)
+                {
+                    size_t j = home(old[i].key);
+                    while (slots[j].key != EMPTY)
+                    {
+                        j = (j + 1) & mask;
+                    }
+                    slots[j] = old[i];
+                }
+            }
+        }
+};
+
+/*
+ * The set of cells not covered by the snake: a bitmap of free cells
+ * plus a Fenwick tree of free counts per 64-cell word. Adding or
+ * removing a cell and finding the k-th free cell in board order take
+ * O(log(cells/64)) steps, so a uniformly random free cell is a single
+ * draw at any fill level. Which cell a draw picks depends only on
+ * which cells are free, never on the order they were freed in, so a
+ * game restored from a saved copy places fruit exactly as the
+ * original did.
+ */
+class FreeCellIndex {
+    public:
+        // Number of free cells.
+        size_t size() const { return count; }
+
+        // The k-th free cell in row-major board order.
+        Cell at(size_t k) const
+        {
+            // Walk down the tree to the word holding the cell.
+            size_t word = 0;
+            for (size_t step = topStep; step > 0; step >>= 1)
+            {
+                if (word + step < tree.size() && (size_t)tree[word + step] <= k)
+                {
+                    word += step;
+                    k -= tree[word];
+                }
+            }
+
+            // Then find the bit, a byte at a time.
+            uint64_t bits = freeBits[word];
+            int bit = 0;
+            while ((size_t)__builtin_popcountll(bits & 0xff) <= k)
+            {
+                k -= __builtin_popcountll(bits & 0xff);
+                bits >>= 8;
+                bit += 8;
+            }
+            for (; k > 0; k--)
+            {
+                bits &= bits - 1;
+            }
+            return indexCell(word*64 + bit + __builtin_ctzll(bits), width);
+        }
+
+        void remove(Cell cell)
+        {
+            long i = cellIndex(cell, width);
+            freeBits[i >> 6] &= ~((uint64_t)1 << (i & 63));
+            update(i >> 6, -1);
+            count--;
+        }
+
+        void add(Cell cell)
+        {
+            long i = cellIndex(cell, width);
+            freeBits[i >> 6] |= (uint64_t)1 << (i & 63);
+            update(i >> 6, 1);
+            count++;
+        }
+
+        // Size the index for a board, or release it with a size of
+        // zero, and mark every cell free.
+        void resize(int width, int height)
+        {
+            if (width == this->width && (long)width*height == area)
+            {
+                reset();
+                return;
+            }
+            this->width = width;
+            area = (long)width*height;
+            // Copying into fresh vectors gives back memory when the
+            // index shrinks.
+            freeBits.assign((area + 63)/64, 0);
+            std::vector<uint64_t>(freeBits).swap(freeBits);
+            tree.assign(freeBits.size() + 1, 0);
+            std::vector<long>(tree).swap(tree);
+            topStep = 1;
+            while (topStep*2 < tree.size())
+            {
+                topStep *= 2;
+            }
+            reset();
+        }
+
+        // Mark every cell free.
+        void reset()
+        {
+            tree.assign(tree.size(), 0);
+            for (size_t w = 0; w < freeBits.size(); w++)
+            {
+                long inWord = area - (long)w*64;
+                freeBits[w] = (inWord >= 64) ? ~(uint64_t)0 : ((uint64_t)1 << inWord) - 1;
+                tree[w + 1] += __builtin_popcountll(freeBits[w]);
+
+                // Pass the partial sum up to the parent node.
+                size_t parent = (w + 1) + ((w + 1) & -(w + 1));
+                if (parent < tree.size())
+                {
+                    tree[parent] += tree[w + 1];
+                }
+            }
+            count = area;
+        }
+
+        FreeCellIndex(int width = BOARD_WIDTH, int height = BOARD_HEIGHT): width(0), area(-1)
+        {
+            resize(width, height);
+        }
+
+    private:
+        int width;
+        long area;
+        std::vector<uint64_t> freeBits;
+
+        // Fenwick tree over the free count of each word, 1-based.
+        std::vector<long> tree;
+        size_t topStep;
+        size_t count;
+
+        void update(size_t word, int delta)
+        {
+            for (size_t i = word + 1; i < tree.size(); i += i & -i)
+            {
+                tree[i] += delta;
+            }
+        }
+};
+
+/*
+ * Turns waiting to be applied, one per tick, in the order the keys
+ * were pressed, each with the time it was pressed. A turn that would
+ * not change the direction the snake will be facing by then, or
+ * would reverse it, is dropped when it arrives, so quick presses
+ * between ticks are all kept and none is wasted on a reversal.
+ */
+class TurnBuffer {
+    public:
+        static const int CAPACITY = 3;
+
+        bool empty() const { return count == 0; }
+
+        // Add a turn for a snake now facing direction. Returns false
+        // if it was dropped.
+        bool push(Input input, unsigned long time, Direction direction)
+        {
+            if (count > 0)
+            {
+                direction = (Direction)(turns[(first + count - 1) % CAPACITY].input - 1);
+            }
+            Direction turn = (Direction)(input - 1);
+            if (input == INPUT_NONE || count == CAPACITY
+                || turn == direction || (turn ^ direction) == 2)
+            {
+                return false;
+            }
+            Turn &slot = turns[(first + count) % CAPACITY];
+            slot.input = input;
+            slot.time = time;
+            count++;
+            return true;
+        }
+
+        // Take the oldest turn. Returns false if there is none.
+        bool pop(Input &input, unsigned long &time)
+        {
+            if (count == 0)
+            {
+                return false;
+            }
+            input = turns[first].input;
+            time = turns[first].time;
+            first = (first + 1) % CAPACITY;
+            count--;
+            return true;
+        }
+
+        void clear()
+        {
+            first = 0;
+            count = 0;
+        }
+
+        TurnBuffer(): first(0), count(0)
+        {
+        }
+
+    private:
+        struct Turn {
+            Input input;
+            unsigned long time;
+        };
+
+        Turn turns[CAPACITY];
+        int first;
+        int count;
+};
+
+/*
+ * How a game ended. A snake that fills the whole board has nowhere
+ * left to put the fruit, which ends the game as well.
+ */
+enum DeathCause {DEATH_NONE, DEATH_WALL, DEATH_SELF, DEATH_BOARD_FULL};
+
+/*
+ * A copy of everything needed to resume a game exactly.
+ */
+struct SavedGame {
+    int width;
+    int height;
+    std::vector<Cell> body;
+    Direction direction;
+    Cell fruit;
+    int score;
+    bool alive;
+    DeathCause death;
+    uint64_t randomState;
+};
+
+/*
+ * The complete state of a single game.
+ */
+class GameState {
+    public:
+        // Advance the game by one cell in the current direction.
+        void step(Input input);
+
+        // Reinitialize the snake, fruit and score.
+        void restart();
+
+        // Reinitialize, drawing fruit from a new seed.
+        void restart(uint64_t seed);
+
+        // Move to a board of another size, and reinitialize.
+        void resize(int width, int height);
+
+        // Copy the game out, or replace it with a saved copy.
+        void save(SavedGame &saved) const;
+        void load(const SavedGame &saved);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // Whether a cell lies on the board.
+        bool contains(Cell cell) const
+        {
+            return cell.x >= 0 && cell.y >= 0 && cell.x < width && cell.y < height;
+        }
+
+        bool isAlive() const { return alive; }
+        DeathCause getDeathCause() const { return death; }
+        int getScore() const { return score; }
+        Direction getDirection() const { return direction; }
+        Cell getFruit() const { return fruit; }
+
+        // Body cells ordered from head to tail.
+        const SnakeBody &getBody() const { return body; }
+
+        // Whether the snake covers the given cell.
+        bool covers(Cell cell) const { return occupied.test(cell); }
+
+        // Cells whose contents changed during the last step.
+        const std::vector<Cell> &getChangedCells() const { return changed; }
+
+        // Each game draws fruit positions from its own seed.
+        GameState(uint64_t seed = 1, int width = BOARD_WIDTH, int height = BOARD_HEIGHT);
+
+    private:
+        int width;
+        int height;
+        SnakeBody body;
+        OccupancyGrid occupied;
+        // Kept up to date only while indexed is set.
+        FreeCellIndex freeCells;
+        bool indexed;
+        std::vector<Cell> changed;
+        Direction direction;
+        Cell fruit;
+        int score;
+        bool alive;
+        DeathCause death;
+        Random random;
+
+        void occupy(Cell cell);
+        void vacate(Cell cell);
+        void placeFruit();
+        void setBoard(int width, int height);
+        void buildIndex();
+        int randomInt(int n);
+};
+
+#endif
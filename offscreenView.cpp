@@ -0,0 +1,145 @@
+/*
+ * Drawing of the game into an RGB image. See offscreenView.h.
+ */
+
+// Import header files.
+#include <cstring>
+#include <string>
+
+#include "offscreenView.h"
+
+using namespace std;
+
+// Digits 0 to 9 in a 3x5 pixel font: five rows of three bits, the
+// top row in the high bits.
+static const uint16_t DIGITS[10] = {
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7249, 0x7bef, 0x7bcf
+};
+
+/*
+ * RgbImage
+ */
+void RgbImage::fillRect(int x, int y, int w, int h, Rgb colour)
+{
+    if (x < 0)
+    {
+        w += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        h += y;
+        y = 0;
+    }
+    if (x + w > width)
+    {
+        w = width - x;
+    }
+    if (y + h > height)
+    {
+        h = height - y;
+    }
+    if (w <= 0 || h <= 0)
+    {
+        return;
+    }
+
+    // Build the first row of the rectangle, then copy it down.
+    uint8_t * first = &pixels[((size_t)y*width + x)*3];
+    for (int i = 0; i < w; i++)
+    {
+        first[i*3] = colour.r;
+        first[i*3 + 1] = colour.g;
+        first[i*3 + 2] = colour.b;
+    }
+    for (int row = 1; row < h; row++)
+    {
+        memcpy(first + (size_t)row*width*3, first, w*3);
+    }
+}
+
+/*
+ * OffscreenView
+ */
+void OffscreenView::paintAll(const GameState &game, RgbImage &image)
+{
+    viewport.follow(game, viewWidth, viewHeight);
+    image.resize(getWidth(), getHeight());
+    image.fillRect(0, 0, getWidth(), getHeight(), RGB_WHITE);
+
+    const SnakeBody &body = game.getBody();
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        if (viewport.contains(body[i]))
+        {
+            paintCell(game, image, body[i]);
+        }
+    }
+    Cell fruit = game.getFruit();
+    if (viewport.contains(fruit))
+    {
+        paintCell(game, image, fruit);
+    }
+    paintInfo(game, image);
+}
+
+void OffscreenView::paintChanged(const GameState &game, RgbImage &image)
+{
+    if (viewport.follow(game, viewWidth, viewHeight))
+    {
+        paintAll(game, image);
+        return;
+    }
+
+    const vector<Cell> &changed = game.getChangedCells();
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        if (viewport.contains(changed[i]))
+        {
+            paintCell(game, image, changed[i]);
+        }
+    }
+    if (game.getScore() != shownScore)
+    {
+        paintInfo(game, image);
+    }
+}
+
+void OffscreenView::paintCell(const GameState &game, RgbImage &image, Cell cell)
+{
+    Cell fruit = game.getFruit();
+    bool on = game.covers(cell) || (cell.x == fruit.x && cell.y == fruit.y);
+    image.fillRect((cell.x - viewport.x)*cellSize, (cell.y - viewport.y)*cellSize,
+                   cellSize, cellSize, on ? RGB_BLACK : RGB_WHITE);
+}
+
+// Draw the separator line and the score, in digits a fifth of the
+// info bar high.
+void OffscreenView::paintInfo(const GameState &game, RgbImage &image)
+{
+    shownScore = game.getScore();
+    int top = viewHeight*cellSize;
+    int line = (cellSize + 9)/10;
+    image.fillRect(0, top, getWidth(), infoHeight, RGB_WHITE);
+    image.fillRect(0, top, getWidth(), line, RGB_BLACK);
+
+    string digits = to_string(shownScore);
+    int dot = (infoHeight/2 + 4)/5;
+    int x = cellSize;
+    int y = top + (infoHeight - 5*dot)/2;
+    for (size_t i = 0; i < digits.length(); i++)
+    {
+        uint16_t glyph = DIGITS[digits[i] - '0'];
+        for (int row = 0; row < 5; row++)
+        {
+            for (int column = 0; column < 3; column++)
+            {
+                if ((glyph >> ((4 - row)*3 + 2 - column)) & 1)
+                {
+                    image.fillRect(x + column*dot, y + row*dot, dot, dot, RGB_BLACK);
+                }
+            }
+        }
+        x += 4*dot;
+    }
+}
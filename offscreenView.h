@@ -0,0 +1,102 @@
+/*
+ * Drawing of the game into an RGB image in memory, with no X server,
+ * for rendering simulated or replayed games to images and video.
+ *
+ * The board is drawn the way the X front-end draws it, black cells on
+ * white, with a separator line and the score in an info bar below.
+ * A board larger than the view is shown through a viewport that
+ * follows the head. After a tick only the cells the tick changed are
+ * redrawn, unless the viewport scrolled.
+ */
+#ifndef OFFSCREEN_VIEW_H
+#define OFFSCREEN_VIEW_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "gameState.h"
+#include "viewport.h"
+
+// Cell size in pixels of the game window, used by default.
+const int DEFAULT_CELL_PIXELS = 20;
+
+/*
+ * A colour as red, green and blue bytes.
+ */
+struct Rgb {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+const Rgb RGB_BLACK = {0, 0, 0};
+const Rgb RGB_WHITE = {255, 255, 255};
+
+/*
+ * An image stored as rows of packed RGB bytes, top row first.
+ */
+class RgbImage {
+    public:
+        void resize(int width, int height)
+        {
+            this->width = width;
+            this->height = height;
+            pixels.resize((size_t)width*height*3);
+        }
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+        const uint8_t * data() const { return pixels.empty() ? NULL : &pixels[0]; }
+        size_t size() const { return pixels.size(); }
+
+        // Fill a rectangle, clipped to the image.
+        void fillRect(int x, int y, int w, int h, Rgb colour);
+
+        RgbImage(): width(0), height(0)
+        {
+        }
+
+    private:
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+};
+
+/*
+ * Draws a game into an image: the board with an info bar below it.
+ */
+class OffscreenView {
+    public:
+        int getWidth() const { return viewWidth*cellSize; }
+        int getHeight() const { return viewHeight*cellSize + infoHeight; }
+
+        // Size the image and draw everything, moving the viewport
+        // over the head.
+        void paintAll(const GameState &game, RgbImage &image);
+
+        // Redraw the cells changed by the last tick, and the info bar
+        // if the score changed.
+        void paintChanged(const GameState &game, RgbImage &image);
+
+        // Show boards of up to viewWidth by viewHeight cells whole,
+        // and larger ones through a viewport of that size.
+        OffscreenView(int cellSize = DEFAULT_CELL_PIXELS, int viewWidth = BOARD_WIDTH,
+                      int viewHeight = BOARD_HEIGHT):
+            cellSize(cellSize), infoHeight(2*cellSize), viewWidth(viewWidth),
+            viewHeight(viewHeight), shownScore(-1)
+        {
+        }
+
+    private:
+        int cellSize;
+        int infoHeight;
+        int viewWidth;
+        int viewHeight;
+        int shownScore;
+        Viewport viewport;
+
+        void paintCell(const GameState &game, RgbImage &image, Cell cell);
+        void paintInfo(const GameState &game, RgbImage &image);
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Timing of the front-end's main loop. See perfStats.h.
+ */
+
+// Import header files.
+#include <algorithm>
+#include <cstdio>
+#include <time.h>
+
+#include "perfStats.h"
+
+using namespace std;
+
+unsigned long now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long us = ts.tv_sec*1000000 + ts.tv_nsec/1000;
+
+    return us;
+}
+
+const char * perfMetricName(PerfMetric metric)
+{
+    switch (metric)
+    {
+        case PERF_REPAINT: return "repaint";
+        case PERF_TICK: return "tick";
+        case PERF_EVENTS: return "events";
+        case PERF_OVERSHOOT: return "overshoot";
+        case PERF_INPUT: return "input";
+        case PERF_TICK_LATE: return "late";
+    }
+    return "unknown";
+}
+
+/*
+ * RollingHistogram
+ */
+unsigned long RollingHistogram::percentile(double fraction) const
+{
+    if (filled == 0)
+    {
+        return 0;
+    }
+    sorted.assign(samples.begin(), samples.begin() + filled);
+    size_t i = fraction*(filled - 1);
+    nth_element(sorted.begin(), sorted.begin() + i, sorted.end());
+    return sorted[i];
+}
+
+unsigned long RollingHistogram::max() const
+{
+    if (filled == 0)
+    {
+        return 0;
+    }
+    return *max_element(samples.begin(), samples.begin() + filled);
+}
+
+/*
+ * PerfStats
+ */
+string PerfStats::summary() const
+{
+    // Milliseconds for p50/p99/max.
+    lock_guard<mutex> guard(lock);
+    string line;
+    char text[64];
+    for (int m = 0; m < PERF_METRIC_COUNT; m++)
+    {
+        const RollingHistogram &h = metrics[m];
+        snprintf(text, sizeof(text), "%s %.2f/%.2f/%.2f", perfMetricName((PerfMetric)m),
+                 h.percentile(0.5)/1000.0, h.percentile(0.99)/1000.0, h.max()/1000.0);
+        line += text;
+        line += (m == PERF_METRIC_COUNT/2 - 1) ? "\n" : " ";
+    }
+    snprintf(text, sizeof(text), "dropped %ld", dropped);
+    return line + text;
+}
+
+void PerfStats::dump(ostream &out) const
+{
+    lock_guard<mutex> guard(lock);
+    out << "metric\tcount\tp50\tp99\tmax\tpeak (us)" << endl;
+    for (int m = 0; m < PERF_METRIC_COUNT; m++)
+    {
+        const RollingHistogram &h = metrics[m];
+        out << perfMetricName((PerfMetric)m) << "\t" << h.getCount() << "\t"
+            << h.percentile(0.5) << "\t" << h.percentile(0.99) << "\t"
+            << h.max() << "\t" << h.getPeak() << endl;
+    }
+    out << "dropped frames: " << dropped << endl;
+}
@@ -0,0 +1,141 @@
+/*
+ * Timing of the front-end's main loop: how long each repaint, tick
+ * and event drain takes, how late the X loop wakes from its sleeps,
+ * how late the simulation runs each tick, how long a key press waits
+ * for the tick that applies it, and how many frames were missed.
+ *
+ * Each measurement feeds a rolling histogram of its most recent
+ * samples, so percentiles follow what the game is doing now. Timers
+ * only read the clock when collection is enabled; otherwise a timer
+ * costs one branch. Samples may be recorded from more than one
+ * thread.
+ */
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Get current time in microseconds from a clock that never jumps.
+unsigned long now();
+
+// Measured phases of the main loop.
+enum PerfMetric {PERF_REPAINT, PERF_TICK, PERF_EVENTS, PERF_OVERSHOOT, PERF_INPUT,
+                 PERF_TICK_LATE};
+const int PERF_METRIC_COUNT = 6;
+
+// Short name of a metric for reports.
+const char * perfMetricName(PerfMetric metric);
+
+/*
+ * The most recent samples of a measurement, in microseconds, plus
+ * totals over the whole run.
+ */
+class RollingHistogram {
+    public:
+        void add(unsigned long sample)
+        {
+            samples[next] = sample;
+            next = (next + 1) % samples.size();
+            if (filled < samples.size())
+            {
+                filled++;
+            }
+            count++;
+            if (sample > peak)
+            {
+                peak = sample;
+            }
+        }
+
+        // Sample at a fraction of the recent samples in sorted order.
+        unsigned long percentile(double fraction) const;
+
+        // Largest recent sample.
+        unsigned long max() const;
+
+        // Number of samples and largest sample over the whole run.
+        long getCount() const { return count; }
+        unsigned long getPeak() const { return peak; }
+
+        RollingHistogram(size_t window = 1024):
+            samples(window), next(0), filled(0), count(0), peak(0)
+        {
+        }
+
+    private:
+        std::vector<unsigned long> samples;
+        size_t next;
+        size_t filled;
+        long count;
+        unsigned long peak;
+
+        // Sorting space for percentiles, reused between calls.
+        mutable std::vector<unsigned long> sorted;
+};
+
+/*
+ * Every histogram plus the count of dropped frames.
+ */
+class PerfStats {
+    public:
+        bool isEnabled() const { return enabled; }
+        void enable() { enabled = true; }
+
+        void record(PerfMetric metric, unsigned long micros)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            metrics[metric].add(micros);
+        }
+
+        void dropFrames(long frames)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            dropped += frames;
+        }
+
+        // The recent p50, p99 and max of each metric, over two lines
+        // split by a newline so they fit across the window.
+        std::string summary() const;
+
+        // Everything, for printing on exit.
+        void dump(std::ostream &out) const;
+
+        PerfStats(): enabled(false), dropped(0)
+        {
+        }
+
+    private:
+        bool enabled;
+        mutable std::mutex lock;
+        RollingHistogram metrics[PERF_METRIC_COUNT];
+        long dropped;
+};
+
+/*
+ * Times the scope it lives in and records it under a metric.
+ */
+class ScopedTimer {
+    public:
+        ScopedTimer(PerfStats &stats, PerfMetric metric):
+            stats(stats), metric(metric), start(stats.isEnabled() ? now() : 0)
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            if (stats.isEnabled())
+            {
+                stats.record(metric, now() - start);
+            }
+        }
+
+    private:
+        PerfStats &stats;
+        PerfMetric metric;
+        unsigned long start;
+};
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * Computer players for headless games. See policy.h.
+ */
+
+// Import header files.
+#include "policy.h"
+
+using namespace std;
+
+const char * policyName(PolicyType type)
+{
+    switch (type)
+    {
+        case RANDOM_POLICY: return "random";
+        case GREEDY_POLICY: return "greedy";
+        case AUTOPILOT_POLICY: return "autopilot";
+    }
+    return "unknown";
+}
+
+Input directionInput(Direction direction)
+{
+    return (Input)(direction + 1);
+}
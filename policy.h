@@ -0,0 +1,144 @@
+/*
+ * Computer players for headless games. A policy looks at the game
+ * state before each tick and chooses the input to apply, the same
+ * way a key press does in the X front-end.
+ *
+ * The policies are written against the game's read interface, so
+ * pick() plays a FixedGame (see fixedGame.h) as well as a GameState;
+ * choose() is pick() on a GameState behind the Policy interface.
+ * The path-finding autopilot is in autopilot.h.
+ */
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "gameState.h"
+#include "random.h"
+
+enum PolicyType {RANDOM_POLICY, GREEDY_POLICY, AUTOPILOT_POLICY};
+const int POLICY_COUNT = 3;
+
+// Short name of a policy for reports.
+const char * policyName(PolicyType type);
+
+/*
+ * An abstract class for policies.
+ */
+class Policy {
+    public:
+        virtual Input choose(const GameState &game) = 0;
+        virtual ~Policy() {}
+};
+
+/*
+ * Keeps going straight, turning at random now and then, and avoids
+ * moves that die at once when it can.
+ */
+class RandomPolicy: public Policy {
+    public:
+        virtual Input choose(const GameState &game) { return pick(game); }
+
+        template <class Game>
+        Input pick(const Game &game);
+
+        RandomPolicy(uint64_t seed): random(seed)
+        {
+        }
+
+    private:
+        Random random;
+};
+
+/*
+ * Heads straight for the fruit, avoiding moves that die at once.
+ */
+class GreedyPolicy: public Policy {
+    public:
+        virtual Input choose(const GameState &game) { return pick(game); }
+
+        template <class Game>
+        Input pick(const Game &game);
+};
+
+// The input that turns the snake towards a direction.
+Input directionInput(Direction direction);
+
+// Whether moving one cell in a direction survives the next tick.
+template <class Game>
+bool isSafeMove(const Game &game, Direction direction)
+{
+    // Reversing is ignored by the game, so it is never a real option.
+    if ((direction ^ game.getDirection()) == 2)
+    {
+        return false;
+    }
+
+    Cell next = neighbour(game.getBody().front(), direction);
+    if (!game.contains(next))
+    {
+        return false;
+    }
+
+    // The tail moves out of the way unless the fruit is eaten.
+    Cell tail = game.getBody().back();
+    Cell fruit = game.getFruit();
+    bool ate = (next.x == fruit.x && next.y == fruit.y);
+    if (!ate && next.x == tail.x && next.y == tail.y)
+    {
+        return true;
+    }
+    return !game.covers(next);
+}
+
+template <class Game>
+Input RandomPolicy::pick(const Game &game)
+{
+    Direction current = game.getDirection();
+    if (random.below(4) != 0 && isSafeMove(game, current))
+    {
+        return INPUT_NONE;
+    }
+
+    // Try the directions starting from a random one.
+    int first = random.below(4);
+    for (int i = 0; i < 4; i++)
+    {
+        Direction direction = (Direction)((first + i) % 4);
+        if (isSafeMove(game, direction))
+        {
+            return directionInput(direction);
+        }
+    }
+    return INPUT_NONE;
+}
+
+template <class Game>
+Input GreedyPolicy::pick(const Game &game)
+{
+    Cell head = game.getBody().front();
+    Cell fruit = game.getFruit();
+
+    // Directions that close the distance to the fruit come first,
+    // then going straight, then anything else.
+    Direction order[7];
+    int count = 0;
+    if (fruit.x > head.x) order[count++] = EAST;
+    if (fruit.x < head.x) order[count++] = WEST;
+    if (fruit.y > head.y) order[count++] = SOUTH;
+    if (fruit.y < head.y) order[count++] = NORTH;
+    order[count++] = game.getDirection();
+    for (int d = 0; d < 4; d++)
+    {
+        order[count++] = (Direction)d;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (isSafeMove(game, order[i]))
+        {
+            return directionInput(order[i]);
+        }
+    }
+    return INPUT_NONE;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * A small, fast, seeded random number generator (PCG32) for giving
+ * every game its own reproducible stream of fruit positions, with
+ * no hidden shared state between games or threads.
+ */
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+class Random {
+    public:
+        // Next 32 random bits.
+        uint32_t next()
+        {
+            uint64_t old = state;
+            state = old*MULTIPLIER + INCREMENT;
+            uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+            uint32_t rot = old >> 59;
+            return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+        }
+
+        // A number in the range [0, n).
+        uint32_t below(uint32_t n)
+        {
+            return ((uint64_t)next()*n) >> 32;
+        }
+
+        // Restart the stream from a seed. Nearby seeds are spread
+        // apart first so consecutive game seeds give unrelated games.
+        void seed(uint64_t seed)
+        {
+            uint64_t z = seed + 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+            state = z ^ (z >> 31);
+            next();
+        }
+
+        // The whole generator state, for saving and restoring a game.
+        uint64_t getState() const { return state; }
+        void setState(uint64_t s) { state = s; }
+
+        Random(uint64_t seed = 1)
+        {
+            this->seed(seed);
+        }
+
+    private:
+        static const uint64_t MULTIPLIER = 6364136223846793005ULL;
+        static const uint64_t INCREMENT = 1442695040888963407ULL;
+
+        uint64_t state;
+};
+
+#endif
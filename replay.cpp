@@ -0,0 +1,426 @@
+/*
+ * Compact binary replays of Snake games. See replay.h.
+ */
+
+// Import header files.
+#include <cstring>
+#include <iterator>
+
+#include "replay.h"
+
+using namespace std;
+
+// Buffered bytes written to the file at a time.
+const size_t FLUSH_SIZE = 65536;
+
+static const char MAGIC[4] = {'S', 'N', 'K', 'R'};
+
+void putVarint(vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(value);
+}
+
+bool getVarint(const uint8_t *data, size_t size, size_t &pos, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7)
+    {
+        uint8_t byte = data[pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * ReplayRecorder
+ */
+bool ReplayRecorder::open(const string &path, uint64_t seed, unsigned long tickInterval,
+                          int width, int height)
+{
+    file.open(path.c_str(), ios::binary | ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    tick = 0;
+    lastEventTick = 0;
+    buffer.clear();
+    for (size_t i = 0; i < sizeof(MAGIC); i++)
+    {
+        buffer.push_back(MAGIC[i]);
+    }
+    putVarint(buffer, REPLAY_VERSION);
+    putVarint(buffer, seed);
+    putVarint(buffer, tickInterval);
+    putVarint(buffer, width);
+    putVarint(buffer, height);
+    return true;
+}
+
+void ReplayRecorder::step(const GameState &game, Input input)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    if (tick > 0 && tick % CHECKPOINT_INTERVAL == 0)
+    {
+        checkpoint(game);
+    }
+    if (input != INPUT_NONE)
+    {
+        event(input);
+    }
+    tick++;
+}
+
+bool ReplayRecorder::close()
+{
+    if (!isOpen())
+    {
+        return true;
+    }
+    event(REPLAY_END);
+    flush();
+    file.close();
+    return !file.fail();
+}
+
+void ReplayRecorder::event(int code)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    putVarint(buffer, tick - lastEventTick);
+    buffer.push_back(code);
+    lastEventTick = tick;
+    if (buffer.size() >= FLUSH_SIZE)
+    {
+        flush();
+    }
+}
+
+// Store the whole game: generator state, direction, score, fruit,
+// and the body as its head cell plus two bits per following cell.
+void ReplayRecorder::checkpoint(const GameState &game)
+{
+    event(REPLAY_CHECKPOINT);
+    game.save(saved);
+
+    putVarint(buffer, saved.randomState);
+    buffer.push_back(saved.direction);
+    buffer.push_back(saved.alive);
+    putVarint(buffer, saved.score);
+    putVarint(buffer, (saved.fruit.x < 0) ? 0 : cellIndex(saved.fruit, saved.width) + 1);
+    putVarint(buffer, saved.body.size());
+    putVarint(buffer, cellIndex(saved.body[0], saved.width));
+
+    size_t packedStart = buffer.size();
+    buffer.resize(packedStart + (saved.body.size() + 2)/4, 0);
+    for (size_t i = 1; i < saved.body.size(); i++)
+    {
+        int direction = stepDirection(saved.body[i - 1], saved.body[i]);
+        buffer[packedStart + (i - 1)/4] |= direction << (((i - 1) % 4)*2);
+    }
+}
+
+void ReplayRecorder::flush()
+{
+    file.write((const char *)&buffer[0], buffer.size());
+    buffer.clear();
+}
+
+/*
+ * ReplayPlayer
+ */
+bool ReplayPlayer::open(const string &path)
+{
+    ifstream in(path.c_str(), ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    storage.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return load(storage.empty() ? NULL : &storage[0], storage.size());
+}
+
+bool ReplayPlayer::load(const uint8_t *bytes, size_t count)
+{
+    data = bytes;
+    size = count;
+    if (size < sizeof(MAGIC) || memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        return false;
+    }
+
+    size_t pos = sizeof(MAGIC);
+    uint64_t version, seed, interval, width, height;
+    if (!getVarint(data, size, pos, version) || version != REPLAY_VERSION
+        || !getVarint(data, size, pos, seed)
+        || !getVarint(data, size, pos, interval)
+        || !getVarint(data, size, pos, width)
+        || !getVarint(data, size, pos, height))
+    {
+        return false;
+    }
+    header.seed = seed;
+    header.tickInterval = interval;
+    if (width == 0 || height == 0 || width > MAX_BOARD_SIDE || height > MAX_BOARD_SIDE)
+    {
+        return false;
+    }
+    header.width = width;
+    header.height = height;
+
+    eventsStart = pos;
+    return index();
+}
+
+// Scan the events once to find the length and the checkpoints. A
+// replay cut short, without an end event, plays up to its last event.
+bool ReplayPlayer::index()
+{
+    checkpoints.clear();
+    size_t pos = eventsStart;
+    long eventTick = 0;
+    while (true)
+    {
+        uint64_t delta;
+        if (!getVarint(data, size, pos, delta) || pos >= size)
+        {
+            length = eventTick;
+            return true;
+        }
+        eventTick += delta;
+
+        int code = data[pos++];
+        if (code == REPLAY_END)
+        {
+            length = eventTick;
+            return true;
+        }
+        else if (code == REPLAY_CHECKPOINT)
+        {
+            Checkpoint checkpoint = {eventTick, pos};
+            if (!readCheckpoint(pos, NULL))
+            {
+                length = eventTick;
+                return true;
+            }
+            checkpoints.push_back(checkpoint);
+        }
+        else if (code > REPLAY_CHECKPOINT)
+        {
+            return false;
+        }
+    }
+}
+
+void ReplayPlayer::start(GameState &game)
+{
+    if (game.getWidth() != header.width || game.getHeight() != header.height)
+    {
+        game.resize(header.width, header.height);
+    }
+    game.restart(header.seed);
+    tick = 0;
+    position = eventsStart;
+    ended = false;
+    paused = false;
+    wasRestarted = false;
+    readNextEventTick(0);
+}
+
+bool ReplayPlayer::step(GameState &game)
+{
+    wasRestarted = false;
+    if (tick >= length)
+    {
+        return false;
+    }
+
+    // Apply every event recorded for this tick.
+    Input input = INPUT_NONE;
+    while (!ended && nextEventTick == tick)
+    {
+        int code = data[position++];
+        switch (code)
+        {
+            case INPUT_NORTH:
+            case INPUT_EAST:
+            case INPUT_SOUTH:
+            case INPUT_WEST:
+                input = (Input)code;
+                break;
+            case REPLAY_PAUSE:
+                paused = true;
+                break;
+            case REPLAY_RESUME:
+                paused = false;
+                break;
+            case REPLAY_RESTART:
+                game.restart();
+                wasRestarted = true;
+                break;
+            case REPLAY_CHECKPOINT:
+                if (!readCheckpoint(position, NULL))
+                {
+                    ended = true;
+                }
+                break;
+            default:
+                ended = true;
+                break;
+        }
+        if (!ended)
+        {
+            readNextEventTick(nextEventTick);
+        }
+    }
+
+    game.step(input);
+    tick++;
+    return true;
+}
+
+void ReplayPlayer::seek(GameState &game, long target)
+{
+    if (target > length)
+    {
+        target = length;
+    }
+
+    // Latest checkpoint at or before the target.
+    const Checkpoint * best = NULL;
+    for (size_t i = 0; i < checkpoints.size() && checkpoints[i].tick <= target; i++)
+    {
+        best = &checkpoints[i];
+    }
+
+    // Restore it unless playing on from where we are is closer.
+    bool ahead = (tick <= target) && (best == NULL || best->tick <= tick);
+    if (!ahead)
+    {
+        // A checkpoint whose body does not fit the board is ignored,
+        // and the game played from the start instead.
+        size_t pos = (best == NULL) ? 0 : best->offset;
+        if (best == NULL || !readCheckpoint(pos, &saved))
+        {
+            start(game);
+        }
+        else
+        {
+            game.load(saved);
+            tick = best->tick;
+            position = pos;
+            ended = false;
+            paused = false;
+            readNextEventTick(best->tick);
+        }
+    }
+
+    while (tick < target && step(game))
+    {
+    }
+}
+
+// Read the tick delta of the event at the current position. The
+// position is left on the event's code.
+void ReplayPlayer::readNextEventTick(long fromTick)
+{
+    uint64_t delta;
+    if (!getVarint(data, size, position, delta) || position >= size)
+    {
+        ended = true;
+        return;
+    }
+    nextEventTick = fromTick + delta;
+}
+
+// Decode a checkpoint at pos into game, or just skip over it when
+// game is NULL. Returns false if the data ends part way through, or
+// holds a game that cannot happen: cells off the board, a body that
+// crosses itself, or fruit on the body.
+bool ReplayPlayer::readCheckpoint(size_t &pos, SavedGame *game)
+{
+    uint64_t randomState, score, fruit, bodyLength, head;
+    if (!getVarint(data, size, pos, randomState) || pos + 2 > size)
+    {
+        return false;
+    }
+    int direction = data[pos++];
+    bool alive = data[pos++];
+    if (!getVarint(data, size, pos, score)
+        || !getVarint(data, size, pos, fruit)
+        || !getVarint(data, size, pos, bodyLength)
+        || !getVarint(data, size, pos, head)
+        || bodyLength == 0 || !alive)
+    {
+        return false;
+    }
+
+    uint64_t area = (uint64_t)header.width*header.height;
+    if (bodyLength > area || head >= area || fruit > area || direction >= 4)
+    {
+        return false;
+    }
+
+    size_t packedStart = pos;
+    uint64_t packedSize = (bodyLength + 2)/4;
+    if (packedSize > size - pos)
+    {
+        return false;
+    }
+    pos += packedSize;
+    if (game == NULL)
+    {
+        return true;
+    }
+
+    game->width = header.width;
+    game->height = header.height;
+    game->randomState = randomState;
+    game->direction = (Direction)direction;
+    // Checkpoints are only taken before a step of a running game.
+    game->alive = alive;
+    game->death = DEATH_NONE;
+    game->score = score;
+    if (fruit == 0)
+    {
+        game->fruit.x = -1;
+        game->fruit.y = -1;
+    }
+    else
+    {
+        game->fruit = indexCell(fruit - 1, header.width);
+    }
+
+    game->body.resize(bodyLength);
+    game->body[0] = indexCell(head, header.width);
+    seen.reset();
+    seen.set(game->body[0]);
+    for (size_t i = 1; i < bodyLength; i++)
+    {
+        int step = (data[packedStart + (i - 1)/4] >> (((i - 1) % 4)*2)) & 3;
+        Cell cell = neighbour(game->body[i - 1], (Direction)step);
+        if (cell.x < 0 || cell.y < 0 || cell.x >= header.width || cell.y >= header.height
+            || seen.test(cell))
+        {
+            return false;
+        }
+        seen.set(cell);
+        game->body[i] = cell;
+    }
+    return fruit == 0 || !seen.test(game->fruit);
+}
@@ -0,0 +1,167 @@
+/*
+ * Compact binary replays of Snake games.
+ *
+ * A replay is the seed a game was started from followed by the
+ * events that changed it: turns, pauses and restarts, each stored as
+ * a varint count of ticks since the previous event and a one byte
+ * code. Every CHECKPOINT_INTERVAL ticks the whole game state is
+ * stored as well, so playback can seek without simulating from the
+ * start. Everything else follows from replaying the ticks.
+ *
+ * Layout: "SNKR", then varints for the version, seed, tick interval
+ * in microseconds, board width and height, then events up to an
+ * end event.
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "gameState.h"
+
+// Event codes. Codes 1 to 4 are turns and match Input.
+enum ReplayEvent {
+    REPLAY_END = 0,
+    REPLAY_PAUSE = 5,
+    REPLAY_RESUME = 6,
+    REPLAY_RESTART = 7,
+    REPLAY_CHECKPOINT = 8
+};
+
+const int REPLAY_VERSION = 1;
+const long CHECKPOINT_INTERVAL = 4096;
+
+// Append an unsigned LEB128 varint.
+void putVarint(std::vector<uint8_t> &out, uint64_t value);
+
+// Read a varint at pos, advancing it. Returns false if the data ends
+// part way through.
+bool getVarint(const uint8_t *data, size_t size, size_t &pos, uint64_t &value);
+
+/*
+ * The fixed part at the start of every replay.
+ */
+struct ReplayHeader {
+    uint64_t seed;
+    unsigned long tickInterval;
+    int width;
+    int height;
+};
+
+/*
+ * Records a game as it is played. Call step() with the input for
+ * every tick of the game, and the other events as they happen.
+ */
+class ReplayRecorder {
+    public:
+        bool open(const std::string &path, uint64_t seed, unsigned long tickInterval,
+                  int width, int height);
+        bool isOpen() const { return file.is_open(); }
+
+        // Record the input applied by the next step of the game,
+        // after a checkpoint of the game as it stands when one is due.
+        void step(const GameState &game, Input input);
+
+        void pause() { event(REPLAY_PAUSE); }
+        void resume() { event(REPLAY_RESUME); }
+        void restart() { event(REPLAY_RESTART); }
+
+        // Write the end of the replay and close the file. Returns
+        // false if any write failed.
+        bool close();
+
+        ReplayRecorder(): tick(0), lastEventTick(0)
+        {
+        }
+
+        ~ReplayRecorder()
+        {
+            close();
+        }
+
+    private:
+        std::ofstream file;
+        std::vector<uint8_t> buffer;
+        SavedGame saved;
+        long tick;
+        long lastEventTick;
+
+        void event(int code);
+        void checkpoint(const GameState &game);
+        void flush();
+};
+
+/*
+ * Plays a replay back into a game, tick by tick or by seeking.
+ */
+class ReplayPlayer {
+    public:
+        // Read a replay file into memory.
+        bool open(const std::string &path);
+
+        // Use replay bytes held elsewhere, such as a mapped file,
+        // without copying them. They must outlive the player.
+        bool load(const uint8_t *data, size_t size);
+
+        const ReplayHeader &getHeader() const { return header; }
+
+        // Number of ticks in the replay, and the next tick to play.
+        long getLength() const { return length; }
+        long getTick() const { return tick; }
+
+        // Whether the player had paused the game at this point, and
+        // whether the last step started a new game.
+        bool isPaused() const { return paused; }
+        bool restarted() const { return wasRestarted; }
+
+        // Start the game from the beginning of the replay.
+        void start(GameState &game);
+
+        // Apply the events for the next tick and step the game.
+        // Returns false once the replay has ended.
+        bool step(GameState &game);
+
+        // Jump to a tick, restoring the nearest earlier checkpoint and
+        // stepping forward from there.
+        void seek(GameState &game, long target);
+
+        ReplayPlayer(): data(NULL), size(0), length(0)
+        {
+        }
+
+    private:
+        struct Checkpoint {
+            long tick;
+            size_t offset;
+        };
+
+        std::vector<uint8_t> storage;
+        const uint8_t *data;
+        size_t size;
+        size_t eventsStart;
+        ReplayHeader header;
+        std::vector<Checkpoint> checkpoints;
+        long length;
+
+        // Playback position: the next tick, the offset and tick of
+        // the next event.
+        long tick;
+        size_t position;
+        long nextEventTick;
+        bool ended;
+        bool paused;
+        bool wasRestarted;
+        SavedGame saved;
+        // Cells of a checkpoint's body decoded so far, reused.
+        OccupancyGrid seen;
+
+        bool index();
+        void readNextEventTick(long fromTick);
+        bool readCheckpoint(size_t &pos, SavedGame *game);
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Packed replay corpora. See replayCorpus.h.
+ */
+
+// Import header files.
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "replayCorpus.h"
+#include "replay.h"
+
+using namespace std;
+
+static const char MAGIC[4] = {'S', 'N', 'K', 'C'};
+const size_t HEADER_SIZE = 24;
+const size_t ENTRY_SIZE = 16;
+
+static void put64(uint8_t *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = value >> (8*i);
+    }
+}
+
+static uint64_t get64(const uint8_t *in)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+/*
+ * ReplayCorpusWriter
+ */
+bool ReplayCorpusWriter::open(const string &path)
+{
+    file.open(path.c_str(), ios::binary | ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // The count and index offset are filled in by close().
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    header[4] = CORPUS_VERSION;
+    file.write((const char *)header, HEADER_SIZE);
+    index.clear();
+    offset = HEADER_SIZE;
+    return true;
+}
+
+bool ReplayCorpusWriter::add(const uint8_t *data, size_t size)
+{
+    ReplayPlayer player;
+    if (!file.is_open() || !player.load(data, size))
+    {
+        return false;
+    }
+
+    Entry entry = {offset, size};
+    index.push_back(entry);
+    file.write((const char *)data, size);
+    offset += size;
+    return true;
+}
+
+bool ReplayCorpusWriter::close()
+{
+    if (!file.is_open())
+    {
+        return true;
+    }
+
+    vector<uint8_t> entries(index.size()*ENTRY_SIZE);
+    for (size_t i = 0; i < index.size(); i++)
+    {
+        put64(&entries[i*ENTRY_SIZE], index[i].offset);
+        put64(&entries[i*ENTRY_SIZE + 8], index[i].size);
+    }
+    if (!entries.empty())
+    {
+        file.write((const char *)&entries[0], entries.size());
+    }
+
+    uint8_t counts[16];
+    put64(counts, index.size());
+    put64(counts + 8, offset);
+    file.seekp(8);
+    file.write((const char *)counts, sizeof(counts));
+    file.close();
+    return !file.fail();
+}
+
+/*
+ * ReplayCorpus
+ */
+bool ReplayCorpus::open(const string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_SIZE)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    base = (const uint8_t *)mapped;
+    length = info.st_size;
+
+    // Replays are mostly visited in file order.
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    count = get64(base + 8);
+    uint64_t indexOffset = get64(base + 16);
+    if (memcmp(base, MAGIC, sizeof(MAGIC)) != 0 || base[4] != CORPUS_VERSION
+        || indexOffset < HEADER_SIZE || indexOffset > length
+        || count > (length - indexOffset)/ENTRY_SIZE)
+    {
+        close();
+        return false;
+    }
+    index = base + indexOffset;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t offset = get64(index + i*ENTRY_SIZE);
+        uint64_t size = get64(index + i*ENTRY_SIZE + 8);
+        if (offset < HEADER_SIZE || offset > indexOffset || size > indexOffset - offset)
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ReplayCorpus::close()
+{
+    if (base != NULL)
+    {
+        munmap((void *)base, length);
+    }
+    base = NULL;
+    length = 0;
+    count = 0;
+    index = NULL;
+}
+
+const uint8_t *ReplayCorpus::recordData(size_t i) const
+{
+    return base + get64(index + i*ENTRY_SIZE);
+}
+
+size_t ReplayCorpus::recordSize(size_t i) const
+{
+    return get64(index + i*ENTRY_SIZE + 8);
+}
@@ -0,0 +1,98 @@
+/*
+ * Many replays packed into one file, for bulk analysis.
+ *
+ * Layout: "SNKC", a 4 byte version, 8 byte replay count and 8 byte
+ * offset of the index, then the replays back to back, then the index:
+ * an 8 byte offset and 8 byte size for every replay. Numbers are
+ * little-endian. The index has fixed-size entries, so a reader can
+ * reach any replay without looking at the others.
+ *
+ * The reader maps the file into memory rather than reading it, so a
+ * corpus larger than memory can be scanned at the speed of the disk
+ * and replays are played straight from the mapped pages.
+ */
+#ifndef REPLAY_CORPUS_H
+#define REPLAY_CORPUS_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+const int CORPUS_VERSION = 1;
+
+/*
+ * Builds a corpus one replay at a time.
+ */
+class ReplayCorpusWriter {
+    public:
+        bool open(const std::string &path);
+
+        // Append one replay. Returns false if it is not a valid replay.
+        bool add(const uint8_t *data, size_t size);
+
+        // Write the index and close the file. Returns false if any
+        // write failed.
+        bool close();
+
+        size_t size() const { return index.size(); }
+
+        ReplayCorpusWriter(): offset(0)
+        {
+        }
+
+        ~ReplayCorpusWriter()
+        {
+            close();
+        }
+
+    private:
+        struct Entry {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        std::ofstream file;
+        std::vector<Entry> index;
+        uint64_t offset;
+};
+
+/*
+ * A corpus mapped read-only into memory.
+ */
+class ReplayCorpus {
+    public:
+        bool open(const std::string &path);
+        void close();
+
+        size_t size() const { return count; }
+
+        // Bytes of a replay inside the mapping, valid until close().
+        const uint8_t *recordData(size_t i) const;
+        size_t recordSize(size_t i) const;
+
+        // Size of the whole file.
+        size_t bytes() const { return length; }
+
+        ReplayCorpus(): base(NULL), length(0), count(0), index(NULL)
+        {
+        }
+
+        ~ReplayCorpus()
+        {
+            close();
+        }
+
+    private:
+        const uint8_t *base;
+        size_t length;
+        size_t count;
+        const uint8_t *index;
+
+        // No copies: the mapping belongs to one object.
+        ReplayCorpus(const ReplayCorpus &);
+        ReplayCorpus &operator=(const ReplayCorpus &);
+};
+
+#endif
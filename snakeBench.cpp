@@ -0,0 +1,395 @@
+/*
+Micro-benchmarks for the hot paths of the game.
+
+Running the command "make bench" in the command-line in the working
+directory will build the snakeBench executable and run it.
+
+    ./snakeBench [--csv]
+
+Each benchmark is repeated until it has run for a fixed time and is
+reported as nanoseconds per operation, as JSON by default or as CSV
+with "--csv", so results can be compared across versions:
+
+    step        GameState::step at several snake lengths.
+    collision   Checking a cell against the snake, the test behind
+                every self-collision check.
+    fruit       Picking a random free cell for the fruit at several
+                fractions of the board filled.
+    paint       Snake::paint into the back buffer.
+    repaint     A full repaint, and a tick followed by the damage-only
+                repaint the game does every frame.
+
+The painting benchmarks are run with Xlib primitives, then again with
+names ending in "_framebuffer" through the client-side framebuffer.
+
+The painting benchmarks draw into an unmapped window on the display
+named by DISPLAY, and are skipped when no display can be opened.
+*/
+
+// Import header files.
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <functional>
+#include <time.h>
+#include <stdint.h>
+
+// Headless game state.
+#include "gameState.h"
+#include "random.h"
+
+// Drawing of the game.
+#include "snakeView.h"
+
+using namespace std;
+
+// Minimum time, in seconds, each benchmark is run for.
+const double MIN_BENCH_TIME = 0.2;
+
+// Snake lengths and fill percentages benchmarked.
+const int LENGTHS[] = {1, 16, 256, 1024, BOARD_WIDTH*BOARD_HEIGHT};
+const int LENGTH_COUNT = sizeof(LENGTHS)/sizeof(LENGTHS[0]);
+const int FILLS[] = {0, 50, 90, 99};
+const int FILL_COUNT = sizeof(FILLS)/sizeof(FILLS[0]);
+
+// Number of pre-drawn random cells cycled through.
+const int RANDOM_CELLS = 4096;
+
+// State drawn by the view.
+GameView game;
+bool showSplash = false;
+bool gamePaused = false;
+
+/*
+ * One benchmark measurement.
+ */
+struct BenchResult {
+    string name;
+    string paramName;
+    long param;
+    long iterations;
+    double nsPerOp;
+};
+vector<BenchResult> results;
+
+// Keeps computed values alive so the loops are not optimized away.
+volatile long sink;
+
+// Get current time in seconds from a clock that never jumps.
+double seconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/*
+ * Run body with doubling iteration counts until it takes at least
+ * MIN_BENCH_TIME, and record the time per iteration of the last run.
+ */
+void measure(const string &name, const string &paramName, long param,
+             const function<void(long)> &body)
+{
+    long iterations = 1;
+    while (true)
+    {
+        double start = seconds();
+        body(iterations);
+        double elapsed = seconds() - start;
+        if (elapsed >= MIN_BENCH_TIME)
+        {
+            BenchResult result = {name, paramName, param, iterations, elapsed*1e9/iterations};
+            results.push_back(result);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+/*
+ * A cycle through every cell of the board: down the even columns,
+ * up the odd ones to the second row, and back along the top row. A
+ * snake following it never dies, whatever its length.
+ */
+struct BoardCycle {
+    vector<Cell> cells;
+    vector<Input> inputs;
+
+    BoardCycle(): inputs(BOARD_WIDTH*BOARD_HEIGHT)
+    {
+        Cell cell = {0, 0};
+        for (int i = 0; i < BOARD_WIDTH*BOARD_HEIGHT; i++)
+        {
+            Input input;
+            if (cell.y == 0)
+            {
+                input = (cell.x > 0) ? INPUT_WEST : INPUT_SOUTH;
+            }
+            else if (cell.x % 2 == 0)
+            {
+                input = (cell.y < BOARD_HEIGHT - 1) ? INPUT_SOUTH : INPUT_EAST;
+            }
+            else if (cell.y > 1 || cell.x == BOARD_WIDTH - 1)
+            {
+                input = INPUT_NORTH;
+            }
+            else
+            {
+                input = INPUT_EAST;
+            }
+            cells.push_back(cell);
+            inputs[cellIndex(cell)] = input;
+            cell = neighbour(cell, (Direction)(input - 1));
+        }
+    }
+
+    // A running game whose snake of the given length lies along the
+    // cycle, with no fruit, so stepping never changes its length.
+    void place(GameState &state, int length) const
+    {
+        SavedGame saved;
+        saved.width = BOARD_WIDTH;
+        saved.height = BOARD_HEIGHT;
+        int head = length - 1;
+        for (int i = 0; i < length; i++)
+        {
+            saved.body.push_back(cells[head - i]);
+        }
+        saved.direction = (Direction)(inputs[cellIndex(cells[head])] - 1);
+        if (length > 1)
+        {
+            saved.direction = stepDirection(cells[head - 1], cells[head]);
+        }
+        saved.fruit.x = -1;
+        saved.fruit.y = -1;
+        saved.score = length - 1;
+        saved.alive = true;
+        saved.death = DEATH_NONE;
+        saved.randomState = 1;
+        state.load(saved);
+    }
+
+    Input next(const GameState &state) const
+    {
+        return inputs[cellIndex(state.getBody().front())];
+    }
+};
+
+void benchStep(const BoardCycle &cycle)
+{
+    GameState state;
+    for (int l = 0; l < LENGTH_COUNT; l++)
+    {
+        cycle.place(state, LENGTHS[l]);
+        measure("step", "length", LENGTHS[l], [&](long n)
+        {
+            for (long i = 0; i < n; i++)
+            {
+                state.step(cycle.next(state));
+            }
+            sink = state.getBody().front().x;
+        });
+    }
+}
+
+void benchCollision(const BoardCycle &cycle)
+{
+    Random random(1);
+    vector<Cell> cells(RANDOM_CELLS);
+    for (int i = 0; i < RANDOM_CELLS; i++)
+    {
+        cells[i] = indexCell(random.below(BOARD_WIDTH*BOARD_HEIGHT));
+    }
+
+    GameState state;
+    for (int l = 0; l < LENGTH_COUNT; l++)
+    {
+        cycle.place(state, LENGTHS[l]);
+        measure("collision", "length", LENGTHS[l], [&](long n)
+        {
+            long hits = 0;
+            for (long i = 0; i < n; i++)
+            {
+                hits += state.covers(cells[i & (RANDOM_CELLS - 1)]);
+            }
+            sink = hits;
+        });
+    }
+}
+
+void benchFruit()
+{
+    int area = BOARD_WIDTH*BOARD_HEIGHT;
+    for (int f = 0; f < FILL_COUNT; f++)
+    {
+        // Cover a random set of cells.
+        Random random(f + 1);
+        FreeCellIndex freeCells;
+        while (freeCells.size() > (size_t)area*(100 - FILLS[f])/100)
+        {
+            freeCells.remove(freeCells.at(random.below(freeCells.size())));
+        }
+
+        measure("fruit", "fill", FILLS[f], [&](long n)
+        {
+            long total = 0;
+            for (long i = 0; i < n; i++)
+            {
+                total += freeCells.at(random.below(freeCells.size())).x;
+            }
+            sink = total;
+        });
+    }
+}
+
+void benchRenderer(XInfo &xInfo, const BoardCycle &cycle, const string &suffix)
+{
+    // Timing includes the server finishing the drawing, and a tick
+    // includes taking what the view draws from the game.
+    GameState state;
+    for (int l = 0; l < LENGTH_COUNT; l++)
+    {
+        cycle.place(state, LENGTHS[l]);
+        game.capture(state);
+        measure("paint" + suffix, "length", LENGTHS[l], [&](long n)
+        {
+            for (long i = 0; i < n; i++)
+            {
+                snake.paint(xInfo);
+            }
+            XSync(xInfo.display, False);
+        });
+
+        measure("repaint_full" + suffix, "length", LENGTHS[l], [&](long n)
+        {
+            for (long i = 0; i < n; i++)
+            {
+                damage.full = true;
+                repaint(xInfo);
+            }
+            XSync(xInfo.display, False);
+        });
+
+        measure("tick_repaint" + suffix, "length", LENGTHS[l], [&](long n)
+        {
+            for (long i = 0; i < n; i++)
+            {
+                state.step(cycle.next(state));
+                game.capture(state);
+                const vector<Cell> &changed = state.getChangedCells();
+                damage.cells.insert(damage.cells.end(), changed.begin(), changed.end());
+                repaint(xInfo);
+            }
+            XSync(xInfo.display, False);
+        });
+    }
+}
+
+void benchPaint(const BoardCycle &cycle)
+{
+    XInfo xInfo;
+    xInfo.display = XOpenDisplay(NULL);
+    if (xInfo.display == NULL)
+    {
+        cerr << "No X display: skipping paint and repaint." << endl;
+        return;
+    }
+
+    // Draw into an unmapped window the same size as the game's.
+    xInfo.screenNumber = DefaultScreen(xInfo.display);
+    unsigned long white = WhitePixel(xInfo.display, xInfo.screenNumber);
+    unsigned long black = BlackPixel(xInfo.display, xInfo.screenNumber);
+    xInfo.window = XCreateSimpleWindow(xInfo.display, DefaultRootWindow(xInfo.display),
+                    0, 0, SCREEN_WIDTH, SCREEN_HEIGHT + INFO_OFFSET, 0, black, white);
+    xInfo.gc = XCreateGC(xInfo.display, xInfo.window, 0, 0);
+    XSetForeground(xInfo.display, xInfo.gc, black);
+    xInfo.clearGC = XCreateGC(xInfo.display, xInfo.window, 0, 0);
+    XSetForeground(xInfo.display, xInfo.clearGC, white);
+    xInfo.buffer = None;
+    createBuffer(xInfo, SCREEN_WIDTH, SCREEN_HEIGHT + INFO_OFFSET);
+    xInfo.tickInterval = 1000000/speedArrray[DEFAULT_SPEED];
+    xInfo.accumulator = xInfo.tickInterval/2;
+
+    initScenes();
+    dList.push_front(&snake);
+    dList.push_front(&fruit);
+    dList.push_front(&scoreText);
+
+    const RendererType renderers[] = {PRIMITIVE_RENDERER, FRAMEBUFFER_RENDERER};
+    for (int r = 0; r < 2; r++)
+    {
+        if (initRenderer(xInfo, renderers[r]) != renderers[r])
+        {
+            cerr << "Framebuffer needs 32-bit pixels: skipping it." << endl;
+            continue;
+        }
+        benchRenderer(xInfo, cycle, (r == 0) ? "" : "_framebuffer");
+    }
+    initRenderer(xInfo, PRIMITIVE_RENDERER);
+
+    XFreePixmap(xInfo.display, xInfo.buffer);
+    XCloseDisplay(xInfo.display);
+}
+
+void printJson()
+{
+    cout << "{\"benchmarks\": [" << endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        cout << "  {\"name\": \"" << r.name << "\", \"" << r.paramName << "\": " << r.param
+             << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.nsPerOp
+             << "}" << ((i + 1 < results.size()) ? "," : "") << endl;
+    }
+    cout << "]}" << endl;
+}
+
+void printCsv()
+{
+    cout << "name,param,value,iterations,ns_per_op" << endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results[i];
+        cout << r.name << "," << r.paramName << "," << r.param << ","
+             << r.iterations << "," << r.nsPerOp << endl;
+    }
+}
+
+/*
+ * Enter main program.
+ */
+int main(int argc, char * argv[])
+{
+    bool csv = false;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--csv")
+        {
+            csv = true;
+        }
+        else
+        {
+            cerr << "Invalid inputs. Usage: snakeBench [--csv]" << endl;
+            return(0);
+        }
+    }
+
+    BoardCycle cycle;
+    benchStep(cycle);
+    benchCollision(cycle);
+    benchFruit();
+    benchPaint(cycle);
+
+    if (csv)
+    {
+        printCsv();
+    }
+    else
+    {
+        printJson();
+    }
+
+    return(0);
+}
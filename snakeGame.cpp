@@ -5,27 +5,60 @@ parameters.
 
 Command-line instructions to compile and run:
 
-    g++ -o snake snake.cpp -L/usr/X11R6/lib -lX11 -lstdc++
-	./snake
+    g++ -o snakeGame snakeGame.cpp snakeView.cpp frameBuffer.cpp perfStats.cpp gameState.cpp replay.cpp tracer.cpp policy.cpp autopilot.cpp -L/usr/X11R6/lib -lX11 -lXext -lstdc++ -pthread
+	./snakeGame
 
 Note: the -L option and -lstdc++ may not be needed on some machines.
 Execution of the above command-line inputs will build an executable
 with the default game parameters.
 
-Change difficulty by specifying an integer in the range [0-9], which
-will specify the desired snake speed. This was primarily used for testing
-purposes so some speeds may lead to white space between snake pixels.An 
-error is displayed if any other argument format is given.
+Change difficulty by specifying an integer in the range [0-4], which
+will specify the desired snake speed. The game advances in fixed ticks
+of one cell; use "--ticks N" to set the number of ticks per second
+directly, which may be faster than the display can show. Use
+"--seed N" to replay the same fruit positions; otherwise a seed is
+chosen from the clock and printed. Use "--record FILE" to save the
+game as a replay, or "--replay FILE" to watch a saved replay instead
+of playing. Use "--board WxH" to play on a board of the given size in
+cells; a board larger than the default 40x37 is shown through a view
+that scrolls with the snake. Use "--autopilot" to watch the computer
+play: a path-finding player turns the snake through the same turn
+queue as the keys, which still work alongside it. An error is
+displayed if any other argument format is given.
+
+Use "--stats" to time each repaint, tick and event drain, how late
+the X loop wakes from its sleeps ("overshoot"), how late the
+simulation runs each tick ("late"), how long a key press waits for
+its tick and how many frames are dropped, and
+print the figures on quitting; "--hud" also shows them in the info
+bar, as milliseconds at the 50th and 99th percentiles and the maximum
+over recent samples. Use "--trace FILE" to record a timeline of input
+handling, ticks, fruit placement, repaints, X flushes and sleeps, and
+write it on quitting as JSON for chrome://tracing or Perfetto.
+
+Use "--renderer framebuffer" to rasterize the board into an image in
+memory and present it in one request, through shared memory when the
+X server offers MIT-SHM, instead of the default "--renderer primitive"
+which draws each cell with Xlib rectangles.
+
+The game is stepped on a simulation thread that keeps its own tick
+cadence. Key presses reach it through a lock-free queue, where up to
+three turns wait to be applied one per tick, and it hands finished
+frames back through a triple buffer, so a slow repaint or X flush
+never delays a tick. X events and drawing stay on the main thread,
+as Xlib is not thread-safe unless initialised for it.
 */
 
 // Import header files.
 #include <iostream>
 #include <cstdlib>
 #include <vector>
-#include <sys/time.h>
+#include <time.h>
 #include <math.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/select.h>
 
 // STL library
 #include <list>
@@ -33,522 +66,114 @@ error is displayed if any other argument format is given.
 #include <map>
 #include <sstream>
 
+// Threads and the handoff between them.
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 // Header files for X functions.
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 
+// Headless game state.
+#include "gameState.h"
+#include "replay.h"
+#include "autopilot.h"
+
+// Drawing of the game.
+#include "snakeView.h"
+#include "perfStats.h"
+#include "tracer.h"
+#include "spscQueue.h"
+#include "tripleBuffer.h"
+
 using namespace std;
 
 /*
  * Global game variables.
  */
-// Screen parameters.
-const int SCREEN_HEIGHT = 750;
-const int SCREEN_WIDTH = 800;
-const int INFO_OFFSET = 40;
-const int WINDOW_CORNER_X = 10;
-const int WINDOW_CORNER_Y = 10;
-const int BORDER_SIZE = 5;
-const int HORIZONTAL_INFO_OFFSET = 25;
-
-// Snake parameters.
-int PIXEL_WIDTH = 20;
-const double INITIAL_CORNER1_X = 300;
-const double INITIAL_CORNER1_Y = 300;
-const double INITIAL_CORNER2_X = (300 + PIXEL_WIDTH);
-const double INITIAL_CORNER2_Y = (300 + PIXEL_WIDTH);
-double speedArrray[5] = {2, 4, 6, 8, 10}; 
-
 // Other game parameters.
-bool showSplash = true;
-bool gamePaused = false;
-bool alive = true;
-int score = 0;
 const double FPS = 30;
+const unsigned long MAX_FRAME_TIME = 250000;
 const int BUFFER_SIZE = 10;
+const unsigned long HUD_INTERVAL = 1000000;
+const size_t COMMAND_QUEUE_SIZE = 64;
 
-/*
- * A struct containing the display, window, screenNumber,
- * graphic context, score, snakeSpeed, deltaTime step, 
- * and a key pressed boolean to incorporate a slight time 
- * delay in the application.
- */
-struct XInfo {
-    Display * display;
-    Window window;
-    int screenNumber;
-    GC gc;
-    int score;
-    double snakeSpeed;
-    unsigned long deltaTime;
-    XPoint currentFruitLoc;
-    bool keyPressedBool;
-};
 // Declare XInfo structure.
 XInfo xInfo;
 
-/*
- * Snake direction enum.
- */
-enum Direction {NORTH, EAST, SOUTH, WEST};
-
-/*
- * An abstract class for displayable objects.
- */
-class Displayable {
-    public:
-        virtual void paint(XInfo &xInfo) = 0;
-};
+// The game as last published by the simulation, and the screen it is
+// on, drawn by the X thread.
+GameView game;
+bool showSplash = true;
+bool gamePaused = false;
+unsigned long shownGeneration = 0;
 
 /*
- * A text displayable class derived from Displayable.
+ * Requests from the X thread to the simulation thread, stamped with
+ * the now() time they were sent.
  */
-class Text: public Displayable {
-    public:
-        virtual void paint(XInfo &xInfo) 
-        {
-            XDrawImageString(xInfo.display, xInfo.window, xInfo.gc,
-                            this->x, this->y, this->s.c_str(), this->s.length());
-        }
-
-        Text(int x, int y, string s): x(x), y(y), s(s)
-        {
-            // Set member variables to input variables.
-        }
+enum SimCommandType {SIM_TURN, SIM_START, SIM_PAUSE, SIM_RESUME, SIM_RESTART, SIM_QUIT};
 
-    private:
-        int x;
-        int y;
-        string s;
+struct SimCommand {
+    SimCommandType type;
+    Input input;
+    unsigned long time;
 };
-// Declare list of pointers to displayable objects.
-list<Displayable *> dList;
-list<Displayable *> dList1;
-list<Displayable *> dList2;
 
 /*
- * A scoreText displayable class derived from Displayable.
+ * What the simulation publishes for the X thread to draw: the part
+ * of the game that is drawn, the cells changed since the last frame
+ * the X thread took, a count bumped whenever the whole board must be
+ * redrawn, the now() time the last tick was due, and the screen
+ * showing.
  */
-class ScoreText: public Displayable {
-    public:
-        virtual void paint (XInfo &xInfo)
-        {
-            XDrawLine(xInfo.display, xInfo.window, xInfo.gc,
-                            0, SCREEN_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT);
-
-            XDrawImageString(xInfo.display, xInfo.window, xInfo.gc,
-                            this->x, this->y,
-                            this->scoreDisplay.c_str(), this->scoreDisplay.length());
-        }
-
-        void updateScore(XInfo &xInfo)
-        {
-            xInfo.score++;
-            scoreDisplay = "Score: " + to_string(xInfo.score);
-        }
-        void reInitScore(XInfo &xInfo)
-        {
-            int scoreZero = 0;
-            scoreDisplay = "Score: " + to_string(scoreZero);
-            xInfo.score = 0;
-        }
-
-        // ScoreText(int x, int y, int score): x(x), y(y)
-        ScoreText(int x, int y): x(x), y(y)
-        {
-            int scoreZero = 0;
-            scoreDisplay = "Score: " + to_string(scoreZero);
-        }
-
-    private:
-        int x;
-        int y;
-        string scoreDisplay;
+struct Frame {
+    GameView game;
+    vector<Cell> cells;
+    unsigned long generation;
+    unsigned long lastTick;
+    bool showSplash;
+    bool paused;
 };
-// Declare ScoreText object.
-ScoreText scoreText(HORIZONTAL_INFO_OFFSET , SCREEN_HEIGHT + 25);
-
-/*
- * A snake displayable class derived from Displayable.
- */
-class Snake : public Displayable {
-    public:
-        virtual void paint(XInfo &xInfo)
-        {
-            list<XPoint> :: iterator it1, it2;
-            it1 = snakeListUL.begin();
-            it2 = snakeListLR.begin();
-            while (it1 != snakeListUL.end())
-            {
-                XFillRectangle(xInfo.display, xInfo.window, xInfo.gc,
-                                it1->x, it1->y,
-                                ((it2->x) - (it1->x)),
-                                ((it2->y) - (it1->y)));
-                it1++;
-                it2++;
-            }
-        }
-
-        // Move function.
-        void move(XInfo &xInfo)
-        {
-            // Get the leading XPoint structures.
-            XPoint leadPixelUL = snakeListUL.front();
-            XPoint leadPixelLR = snakeListLR.front();
-            
-            // Set new lead pixels for tracking the length snake.
-            XPoint newLeadPixelUL;
-            XPoint newLeadPixelLR;
-
-            // Set new lead corner pixels for tracking collisions.
-            XPoint newLeadCorner1;
-            XPoint newLeadCorner2;
-
-            switch (direction)
-            {
-                // Set new lead pixel coordinates for movement in the North direction.
-                // Set new lead conrer pixels for movement in the North direction.
-                case NORTH:
-                    newLeadPixelUL.x = leadPixelUL.x;
-                    newLeadPixelUL.y = leadPixelUL.y - (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelLR.x = leadPixelLR.x;
-                    newLeadPixelLR.y = leadPixelLR.y - (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    
-                    newLeadCorner1.x = newLeadPixelUL.x;
-                    newLeadCorner1.y = newLeadPixelUL.y;
-                    newLeadCorner2.x = newLeadPixelLR.x ;
-                    newLeadCorner2.y = newLeadPixelLR.y - PIXEL_WIDTH;
-                    break;
-
-                // Set new lead pixel coordinates for movement in the East direction.
-                // Set new lead conrer pixels for movement in the East direction.
-                case EAST:
-                    newLeadPixelUL.x = leadPixelUL.x + (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelUL.y = leadPixelUL.y;
-                    newLeadPixelLR.x = leadPixelLR.x + (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelLR.y = leadPixelLR.y;
-
-                    newLeadCorner1.x = newLeadPixelUL.x + PIXEL_WIDTH;
-                    newLeadCorner1.y = newLeadPixelUL.y;
-                    newLeadCorner2.x = newLeadPixelLR.x;
-                    newLeadCorner2.y = newLeadPixelLR.y;
-                    break;
 
-                // Set new lead pixel coordinates for movement in the South direction.
-                // Set new lead conrer pixels for movement in the South direction.
-                case SOUTH:
-                    newLeadPixelUL.x = leadPixelUL.x;
-                    newLeadPixelUL.y = leadPixelUL.y + (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelLR.x = leadPixelLR.x;
-                    newLeadPixelLR.y = leadPixelLR.y + (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    
-                    newLeadCorner1.x = newLeadPixelUL.x;
-                    newLeadCorner1.y = newLeadPixelUL.y + PIXEL_WIDTH;
-                    newLeadCorner2.x = newLeadPixelLR.x;
-                    newLeadCorner2.y = newLeadPixelLR.y;
-                    break;
-
-                // Set new lead pixel coordinates for movement in the West direction.
-                // Set new lead conrer pixels for movement in the West direction.
-                case WEST:
-                    newLeadPixelUL.x = leadPixelUL.x - (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelUL.y = leadPixelUL.y;
-                    newLeadPixelLR.x = leadPixelLR.x - (xInfo.snakeSpeed*xInfo.deltaTime)/1000000;
-                    newLeadPixelLR.y = leadPixelLR.y;
-
-                    newLeadCorner1.x = newLeadPixelUL.x;
-                    newLeadCorner1.y = newLeadPixelUL.y;
-                    newLeadCorner2.x = newLeadPixelLR.x - PIXEL_WIDTH;
-                    newLeadCorner2.y = newLeadPixelLR.y;
-                    break;
-            }           
-            
-            // Check if snake is in contact with the wall.
-            if (newLeadPixelUL.x < 0 || newLeadPixelUL.y < 0)
-            {
-                alive = false;
-            }
-            else if (newLeadPixelLR.x > SCREEN_WIDTH || newLeadPixelLR.y > SCREEN_HEIGHT)
-            {
-                alive = false;
-            }    
-
-            // Print out of snake pixel coordinates for debugging.
-
-            // cout << "UL.x " << newLeadPixelUL.x << " & " << "UL.y" << newLeadPixelUL.y << endl;
-            // cout << "LR.x" << newLeadPixelLR.x << " & " << "LR.y" << newLeadPixelLR.y << endl;
-            // cout << " " << endl;
-               
-            /* 
-             * Check if snake is in contact with itself.
-             * This is achieved by checking if the lead
-             * corner pixel coordinates occur in the list
-             * of snake pixels.
-             */ 
-            list<XPoint> :: iterator iter1 = snakeListUL.begin();
-            list<XPoint> :: iterator iter2 = snakeListLR.begin();;
-
-            if (!xInfo.keyPressedBool)
-            {
-                while (iter1 != snakeListUL.end())
-                {
-                    if ( (iter1->x < newLeadCorner1.x)
-                        && (iter2->x > newLeadCorner1.x)
-                        && (iter1->y < newLeadCorner1.y)
-                        && (iter2->y > newLeadCorner1.y) )
-                    {
-                        alive = false;
-                    }
-
-                    if ( (iter1->x < newLeadCorner2.x)
-                        && (iter2->x > newLeadCorner2.x)
-                        && (iter1->y < newLeadCorner2.y)
-                        && (iter2->y > newLeadCorner2.y) )
-                    {
-                        alive = false;
-                    }
-                    iter1++;
-                    iter2++;
-                }
-            }
-
-            // Add new lead pixel to snakeList.
-            snakeListUL.push_front(newLeadPixelUL);
-            snakeListLR.push_front(newLeadPixelLR);
-
-            // Check if snake is in contact with fruit.
-            // If it is not then pop_back the trailing
-            // pixel, if it is then keep the trailing 
-            // pixel.
-            double tempFruitX = xInfo.currentFruitLoc.x;
-            double tempFruitY = xInfo.currentFruitLoc.y;
-
-            if ( (newLeadCorner1.x > tempFruitX)
-                && (newLeadCorner1.x < tempFruitX + PIXEL_WIDTH)
-                && (newLeadCorner1.y > tempFruitY)
-                && ( newLeadCorner1.y < tempFruitY + PIXEL_WIDTH) )
-            {
-                updateFruitLoc(xInfo);
-                scoreText.updateScore(xInfo);
-            }
-            else if ( (newLeadCorner2.x > tempFruitX)
-                && (newLeadCorner2.x < tempFruitX + PIXEL_WIDTH)
-                && (newLeadCorner2.y > tempFruitY)
-                && ( newLeadCorner2.y < tempFruitY + PIXEL_WIDTH) )
-            {
-                updateFruitLoc(xInfo);
-                scoreText.updateScore(xInfo);
-            }
-            else
-            {
-                // Remove last set of XPoint structures that 
-                // corresponds to the trailing pixel.
-                snakeListUL.pop_back();
-                snakeListLR.pop_back();
-            }
-        }
-
-        // Update fruit to random location after snake eats it/
-        void updateFruitLoc(XInfo &xInfo)
-        {
-            double randX;
-            double randY;
-
-            bool loop = true;
-
-            list<XPoint> :: iterator iterate1 = snakeListUL.begin();
-            list<XPoint> :: iterator iterate2 = snakeListLR.begin();;
-
-            while(loop)
-            {
-                randX = rand() % (SCREEN_WIDTH - 2*PIXEL_WIDTH) + PIXEL_WIDTH;
-                randY = rand() % (SCREEN_HEIGHT - 2*PIXEL_WIDTH - INFO_OFFSET) + PIXEL_WIDTH;
-                xInfo.currentFruitLoc.x = randX;
-                xInfo.currentFruitLoc.y = randY;
-
-                while (iterate1 != snakeListUL.end())    
-                {
-                    loop = false;
-                    if (xInfo.currentFruitLoc.x > iterate1->x
-                        && xInfo.currentFruitLoc.x < iterate2->x
-                        && xInfo.currentFruitLoc.y > iterate1->y
-                        && xInfo.currentFruitLoc.y < iterate2->y)
-                    {
-                        loop = true;
-                    }
-                    iterate1++;
-                    iterate2++;
-                }             
-            }
-        }
-        
-        // Reinitialize snake on restart.
-        void restart()
-        {
-            snakeListUL.clear();
-            snakeListLR.clear();
-            initSnake();
-        }
-
-        // Move North.
-        void pressUpKey()
-        {
-            if ( direction != SOUTH)
-            {
-                direction = NORTH;
-            }
-        }
-
-        // Move East.
-        void pressRightKey()
-        {
-            if ( direction != WEST)
-            {
-                direction = EAST;
-            }
-        }
-
-        // Move South.
-        void pressDownKey()
-        {
-            if ( direction != NORTH)
-            {
-                direction = SOUTH;
-            }
-        }
-
-        // Move West.
-        void pressLeftKey()
-        {
-            if ( direction != EAST)
-            {
-                direction = WEST;
-            }
-        }
-
-        list<XPoint> getSnakeListUL()
-        {
-            return snakeListUL;
-        } 
-
-        list<XPoint> getSnakeListLR()
-        {
-            return snakeListLR;
-        }
-
-        // Snake constructor.
-		Snake()
-        {
-            /* 
-             * Add corner1 to list of (x,y) coordinates for all
-             * upper left pixel corners, and add corner2 to list
-             * of (x,y) coordinates for all lower righ pixel corners.
-             * Set East as the default direction of the snake.
-             */
-            corner1.x = INITIAL_CORNER1_X;
-            corner1.y = INITIAL_CORNER1_Y;
-            corner2.x = INITIAL_CORNER2_X;
-            corner2.y = INITIAL_CORNER2_Y;
-			snakeListUL.push_front(corner1);
-            snakeListLR.push_front(corner2);
-            direction = EAST;
-		}
-
-    private:
-        XPoint corner1;
-        XPoint corner2;
-        Direction direction;
-        list<XPoint> snakeListUL;
-        list<XPoint> snakeListLR;
-
-        void initSnake()
-        {
-            corner1.x = INITIAL_CORNER1_X;
-            corner1.y = INITIAL_CORNER1_Y;
-            corner2.x = INITIAL_CORNER2_X;
-            corner2.y = INITIAL_CORNER2_X;
-			snakeListUL.push_front(corner1);
-            snakeListLR.push_front(corner2);
-            direction = EAST;
-        }
-};
-// Declare Snake object.
-Snake snake;
-
-/*
- * A fruit displayable class derived from Displayable.
- */
-class Fruit: public Displayable {
-    public:
-        virtual void paint(XInfo &xInfo)
-        {
-            XFillRectangle(xInfo.display, xInfo.window, xInfo.gc,
-                            xInfo.currentFruitLoc.x, 
-                            xInfo.currentFruitLoc.y,
-                            PIXEL_WIDTH, PIXEL_WIDTH);
-        }
-
-        void regenerateFruit(XInfo &xInfo)
-        {
-            list<XPoint> tempSnakeListUL = snake.getSnakeListUL();
-            list<XPoint> tempSnakeListLR = snake.getSnakeListLR();
-
-            list<XPoint> :: iterator iterate1, iterate2;
-            iterate1 = tempSnakeListUL.begin();
-            iterate2 = tempSnakeListLR.begin();
-
-            bool loop = true;
-
-            while(loop)
-            {
-                randX = rand() % (SCREEN_WIDTH - 2*PIXEL_WIDTH) + PIXEL_WIDTH;
-                randY = rand() % (SCREEN_HEIGHT - 2*PIXEL_WIDTH - INFO_OFFSET) + PIXEL_WIDTH;
-                xInfo.currentFruitLoc.x = randX;
-                xInfo.currentFruitLoc.y = randY;
-
-                while (iterate1 != tempSnakeListUL.end())    
-                {
-                    loop = false;
-                    if (xInfo.currentFruitLoc.x > iterate1->x
-                        && xInfo.currentFruitLoc.x < iterate2->x
-                        && xInfo.currentFruitLoc.y > iterate1->y
-                        && xInfo.currentFruitLoc.y < iterate2->y)
-                    {
-                        loop = true;
-                    }
-                    iterate1++;
-                    iterate2++;
-                }             
-            }
-        }
-
-        Fruit(XInfo &xInfo)
-        {
-            // Initialize fruit in the drawable area that does
-            // not intersect with the initial snake location.
-            do
-            {
-                randX = rand() % (SCREEN_WIDTH - 2*PIXEL_WIDTH) + PIXEL_WIDTH;
-                randY = rand() % (SCREEN_HEIGHT - 2*PIXEL_WIDTH - INFO_OFFSET) + PIXEL_WIDTH;
-                xInfo.currentFruitLoc.x = randX;
-                xInfo.currentFruitLoc.y = randY; 
-            } while ((randX > INITIAL_CORNER1_X
-                    && randX < INITIAL_CORNER2_X
-                    && randY > INITIAL_CORNER1_Y
-                    && randY < INITIAL_CORNER2_Y)
-                    || (randX + PIXEL_WIDTH > INITIAL_CORNER1_X
-                    && randX + PIXEL_WIDTH < INITIAL_CORNER2_X
-                    && randY + PIXEL_WIDTH > INITIAL_CORNER1_Y
-                    && randY + PIXEL_WIDTH < INITIAL_CORNER2_Y));
-        }
-
-    private:
-        double randX;
-        double randY;
-        XPoint currentFruitLoc; 
-};
-// Declare fruit object
-Fruit fruit(xInfo);
+// Handoff between the threads: commands one way, frames the other.
+// The simulation sleeps on wakeSignal while it has nothing to do,
+// and wakes the X thread through renderPipe when the screen changes.
+SpscQueue<SimCommand> commands(COMMAND_QUEUE_SIZE);
+TripleBuffer<Frame> frames;
+mutex wakeLock;
+condition_variable wakeSignal;
+int renderPipe[2];
+thread simThread;
+
+// State owned by the simulation thread.
+GameState simGame;
+bool simSplash = true;
+bool simPaused = false;
+TurnBuffer turns;
+unsigned long pausedAt = 0;
+unsigned long generation = 0;
+vector<Cell> unseenCells;
+size_t publishedCells = 0;
+
+// Replay being recorded, or played back in place of the keyboard.
+// Only the simulation thread touches them once it has started.
+ReplayRecorder recorder;
+ReplayPlayer player;
+bool replaying = false;
+bool replayEnded = false;
+
+// Computer player turning the snake in demo mode, with --autopilot.
+AutopilotPolicy autopilot;
+bool autopilotEnabled = false;
+
+// Timings of the main loop, collected with --stats or --hud.
+PerfStats perfStats;
+
+// Where the timeline trace is written on quitting, with --trace.
+string tracePath;
 
 void error(string str)
 {
@@ -559,16 +184,6 @@ void error(string str)
     exit(0);
 }
 
-// Get current time in microseconds.
-unsigned long now()
-{
-    timeval tv;
-    gettimeofday(&tv, NULL);
-    unsigned long us = tv.tv_sec*1000000 + tv.tv_usec;
-
-    return us;
-}
-
 /*
  * Create X window.
  */ 
@@ -619,9 +234,10 @@ void initXWindow(int argc, char * argv[], XInfo &xInfo)
 
     // Set event to monitor window.
 	XSelectInput(xInfo.display, xInfo.window, 
-		ButtonPressMask | KeyPressMask | KeyReleaseMask |
+		ButtonPressMask | KeyPressMask |
 		PointerMotionMask | 
 		EnterWindowMask | LeaveWindowMask |
+		ExposureMask |
 		StructureNotifyMask);  // for resize events
 
 	xInfo.gc = XCreateGC(xInfo.display, xInfo.window, 0, 0);
@@ -630,6 +246,19 @@ void initXWindow(int argc, char * argv[], XInfo &xInfo)
 	XSetFillStyle(xInfo.display, xInfo.gc, FillSolid);
 	XSetLineAttributes(xInfo.display, xInfo.gc, 2, LineSolid, CapButt, JoinRound);
 
+    // Graphics context used to clear the back buffer.
+	xInfo.clearGC = XCreateGC(xInfo.display, xInfo.window, 0, 0);
+	XSetForeground(xInfo.display, xInfo.clearGC, white);
+
+    // Create the back buffer frames are drawn into before being
+    // copied to the window in one request.
+    xInfo.buffer = None;
+    createBuffer(xInfo, hints.width, hints.height);
+
+    // Every pixel is copied from the buffer, so stop the server
+    // clearing the window to its background first.
+	XSetWindowBackgroundPixmap(xInfo.display, xInfo.window, None);
+
     // Window name.
     XStoreName(xInfo.display, xInfo.window, "BREAKOUT!");
 
@@ -643,10 +272,326 @@ void initXWindow(int argc, char * argv[], XInfo &xInfo)
     // sleep(1);
 }
 
+/*
+ * Send a request to the simulation thread and wake it. Returns false,
+ * dropping the request, if the simulation has fallen behind.
+ */
+bool sendCommand(SimCommandType type, Input input = INPUT_NONE)
+{
+    SimCommand command = {type, input, now()};
+    if (!commands.push(command))
+    {
+        return false;
+    }
+
+    // Taking the lock makes sure the simulation is either still
+    // before its check of the queue or already waiting.
+    {
+        lock_guard<mutex> guard(wakeLock);
+    }
+    wakeSignal.notify_one();
+    return true;
+}
+
+/*
+ * Publish the game for the X thread to draw.
+ */
+void publishFrame(unsigned long nextTick)
+{
+    Frame &frame = frames.writeBuffer();
+    frame.game.capture(simGame);
+    frame.cells = unseenCells;
+    frame.generation = generation;
+    frame.lastTick = nextTick - xInfo.tickInterval;
+    frame.showSplash = simSplash;
+    frame.paused = simPaused;
+
+    // Cells stay unseen until a frame holding them has been taken.
+    if (frames.publish())
+    {
+        unseenCells.erase(unseenCells.begin(), unseenCells.begin() + publishedCells);
+    }
+    publishedCells = unseenCells.size();
+}
+
+/*
+ * Execute animation of snake: one fixed tick of the game.
+ */
+void handleAnimation()
+{
+    ScopedTimer timer(perfStats, PERF_TICK);
+    TraceSpan span("tick");
+    if (replaying)
+    {
+        if (!player.step(simGame))
+        {
+            replayEnded = true;
+            return;
+        }
+        if (player.restarted())
+        {
+            generation++;
+        }
+    }
+    else
+    {
+        // In demo mode the autopilot queues a turn, as a key press
+        // would, whenever none is waiting. Its turn is the one taken
+        // next, and is not a key press to time.
+        bool automatic = false;
+        if (autopilotEnabled && turns.empty())
+        {
+            automatic = turns.push(autopilot.choose(simGame), now(), simGame.getDirection());
+        }
+
+        // Apply the oldest waiting turn, and time how long it waited.
+        Input input = INPUT_NONE;
+        unsigned long pressed;
+        if (turns.pop(input, pressed) && perfStats.isEnabled() && !automatic)
+        {
+            perfStats.record(PERF_INPUT, now() - pressed);
+        }
+        recorder.step(simGame, input);
+        simGame.step(input);
+    }
+
+    // Remember which cells need redrawing. If the X thread has
+    // fallen so far behind that redrawing them all would cost more
+    // than the whole window, ask for that instead.
+    const vector<Cell> &changed = simGame.getChangedCells();
+    unseenCells.insert(unseenCells.end(), changed.begin(), changed.end());
+    if (unseenCells.size() > (size_t)BOARD_WIDTH*BOARD_HEIGHT)
+    {
+        unseenCells.clear();
+        publishedCells = 0;
+        generation++;
+    }
+}
+
+/*
+ * Apply a request from the X thread. Returns whether the screen
+ * changed.
+ */
+bool applyCommand(const SimCommand &command, unsigned long &nextTick)
+{
+    switch (command.type)
+    {
+        case SIM_TURN:
+            if (!simSplash && !simPaused)
+            {
+                turns.push(command.input, command.time, simGame.getDirection());
+            }
+            return false;
+        case SIM_START:
+            if (!simSplash)
+            {
+                return false;
+            }
+            simSplash = false;
+            nextTick = now() + xInfo.tickInterval;
+            return true;
+        case SIM_PAUSE:
+            if (simSplash || simPaused)
+            {
+                return false;
+            }
+            simPaused = true;
+            recorder.pause();
+            pausedAt = now();
+            return true;
+        case SIM_RESUME:
+            if (!simPaused)
+            {
+                return false;
+            }
+            simPaused = false;
+            recorder.resume();
+
+            // Carry on from where the clock was at the pause.
+            nextTick += now() - pausedAt;
+            return true;
+        case SIM_RESTART:
+            if (simSplash || simGame.isAlive())
+            {
+                return false;
+            }
+            simPaused = false;
+            if (replaying)
+            {
+                player.start(simGame);
+                replayEnded = false;
+            }
+            else
+            {
+                simGame.restart();
+                recorder.restart();
+            }
+            turns.clear();
+            unseenCells.clear();
+            publishedCells = 0;
+            generation++;
+            nextTick = now() + xInfo.tickInterval;
+            return true;
+        case SIM_QUIT:
+            return false;
+    }
+    return false;
+}
+
+/*
+ * Run the game on its own thread: apply requests from the X thread,
+ * step the game in fixed ticks on the now() clock, and publish a
+ * frame whenever the game changes. Drawing never delays a tick.
+ */
+void simulationLoop()
+{
+    traceThreadName("simulation");
+    unsigned long nextTick = now();
+    publishFrame(nextTick);
+
+    while (true)
+    {
+        bool screenChanged = false;
+        bool gameChanged = false;
+        SimCommand command;
+        while (commands.pop(command))
+        {
+            if (command.type == SIM_QUIT)
+            {
+                return;
+            }
+            screenChanged |= applyCommand(command, nextTick);
+        }
+
+        // A replay keeps going after a death to reach its restart.
+        bool running = !simSplash && !simPaused
+                       && (replaying ? !replayEnded : simGame.isAlive());
+        if (running)
+        {
+            unsigned long current = now();
+
+            // Don't try to catch up on more than a short stall.
+            if (current > nextTick + MAX_FRAME_TIME)
+            {
+                nextTick = current - MAX_FRAME_TIME;
+            }
+
+            // How late the tick that was due is being run.
+            if (perfStats.isEnabled() && current >= nextTick)
+            {
+                perfStats.record(PERF_TICK_LATE, current - nextTick);
+            }
+
+            bool wasAlive = simGame.isAlive();
+            unsigned long lastGeneration = generation;
+            while (running && current >= nextTick)
+            {
+                handleAnimation();
+                nextTick += xInfo.tickInterval;
+                gameChanged = true;
+                running = replaying ? !replayEnded : simGame.isAlive();
+            }
+            screenChanged |= (simGame.isAlive() != wasAlive || generation != lastGeneration
+                              || replayEnded);
+        }
+
+        if (screenChanged || gameChanged)
+        {
+            publishFrame(nextTick);
+        }
+
+        // Wake the X thread, which may be asleep until the next key
+        // press, when there is a new screen to show.
+        if (screenChanged)
+        {
+            char byte = 0;
+            if (write(renderPipe[1], &byte, 1) < 0)
+            {
+                // The pipe is full, so the X thread is awake anyway.
+            }
+        }
+
+        // Sleep until the next tick is due or a request arrives.
+        unique_lock<mutex> lock(wakeLock);
+        if (commands.empty())
+        {
+            if (running)
+            {
+                unsigned long current = now();
+                if (nextTick > current)
+                {
+                    wakeSignal.wait_for(lock, chrono::microseconds(nextTick - current));
+                }
+            }
+            else
+            {
+                wakeSignal.wait(lock);
+            }
+        }
+    }
+}
+
+/*
+ * Take the latest frame from the simulation, if there is a new one.
+ */
+void takeFrame(unsigned long &lastTick)
+{
+    if (!frames.update())
+    {
+        return;
+    }
+
+    Frame &frame = frames.readBuffer();
+    if (frame.generation != shownGeneration)
+    {
+        damage.full = true;
+        shownGeneration = frame.generation;
+    }
+    // The game is swapped out rather than copied. The buffer it
+    // leaves behind is overwritten before it is published again.
+    game.swap(frame.game);
+    damage.cells.insert(damage.cells.end(), frame.cells.begin(), frame.cells.end());
+    lastTick = frame.lastTick;
+    gamePaused = frame.paused;
+
+    // Swap the splash for the game once it has started.
+    if (showSplash && !frame.showSplash)
+    {
+        dList.clear();
+        dList.push_front(&snake);
+        dList.push_front(&fruit);
+        dList.push_front(&scoreText);
+    }
+    showSplash = frame.showSplash;
+}
+
+/*
+ * Stop the simulation and leave, saving what was asked for.
+ */
+void quit()
+{
+    while (!sendCommand(SIM_QUIT))
+    {
+        this_thread::yield();
+    }
+    simThread.join();
+
+    recorder.close();
+    if (perfStats.isEnabled())
+    {
+        perfStats.dump(cout);
+    }
+    if (traceEnabled && !writeTrace(tracePath))
+    {
+        cerr << "Cannot write trace file " << tracePath << "." << endl;
+    }
+    error("Exit Snake appplication normally.");
+}
+
 /*
  * Handle keyboard inputs.
  */
-void keyPressInput(XInfo &xInfo, XEvent &event)
+void keyPressInput(XEvent &event)
 {
     KeySym key;
     char text[BUFFER_SIZE];
@@ -667,114 +612,64 @@ void keyPressInput(XInfo &xInfo, XEvent &event)
             // Start game.
             if (i == 1 && text[0] == ' ' && showSplash)
             {
-                dList.clear();
-                dList.push_front(&snake);
-                dList.push_front(&fruit);
-                dList.push_front(&scoreText);
-                showSplash = false;
+                sendCommand(SIM_START);
             }
 
-            // Restart game after losing.
-            if (i == 1 && text[0] == ' ' && !alive)
+            // Restart game after losing. A finished replay starts over.
+            if (i == 1 && text[0] == ' ' && !showSplash && !game.isAlive())
             {
-                // while(!dList.empty()) delete dList.front(), dList.pop_front();
-                // showSplash = true;
-                alive = true;
-                gamePaused = false;
-                dList.clear();
-                // xInfo.score = 0;
-                scoreText.reInitScore(xInfo);
-                snake.restart();
-                snake.updateFruitLoc(xInfo);
-                dList.push_front(&snake);
-                dList.push_front(&fruit);
-                dList.push_front(&scoreText);
+                sendCommand(SIM_RESTART);
             }
 
             // Quit game.
             if (i == 1 && text[0] == 'q')
             {
-                // while(!dList.empty()) delete dList.front(), dList.pop_front();
-                error("Exit Snake appplication normally.");
-                XCloseDisplay(xInfo.display);
+                quit();
             }
 
             // Pause game.
             if (i == 1 && text[0] == 'p' && !gamePaused)
             {
-                gamePaused = true;
+                sendCommand(SIM_PAUSE);
             }
 
             // Unpause game.
             if (i == 1 && text[0] == 'u' && gamePaused)
             {
-                gamePaused = false;
+                sendCommand(SIM_RESUME);
+            }
+
+            // A replay ignores the arrow keys.
+            if (replaying)
+            {
+                break;
             }
+
             // Snake action based on arrow key inputs.
             switch (key)
             {
                 // Move North.
                 case XK_Up:
                 {
-                    snake.pressUpKey();
-                    xInfo.keyPressedBool = true;
-                    // cout << "press" << endl;
+                    sendCommand(SIM_TURN, INPUT_NORTH);
                     break;
                 }
                 // Move South.
                 case XK_Down:
                 {
-                    snake.pressDownKey();
-                    xInfo.keyPressedBool = true;
-                    // cout << "press" << endl;
+                    sendCommand(SIM_TURN, INPUT_SOUTH);
                     break;
                 }
                 // Move East.
                 case XK_Right:
                 {
-                    snake.pressRightKey();
-                    xInfo.keyPressedBool = true;
-                    // cout << "press" << endl;
+                    sendCommand(SIM_TURN, INPUT_EAST);
                     break;
                 }
                 // Move West.
                 case XK_Left:
                 {
-                    snake.pressLeftKey();
-                    xInfo.keyPressedBool = true;
-                    // cout << "press" << endl;
-                    break;
-                }
-            }
-            break;
-        }
-        case KeyRelease:
-        {
-            int i = XLookupString((XKeyEvent*)&event, text, 10, &key, 0);
-            switch (key)
-            {
-                case XK_Up:
-                {
-                    xInfo.keyPressedBool = false;
-                    // cout << "release" << endl;
-                    break;
-                }
-                case XK_Down:
-                {
-                    xInfo.keyPressedBool = false;
-                    // cout << "release" << endl;
-                    break;
-                }
-                case XK_Right:
-                {
-                    xInfo.keyPressedBool = false;
-                    // cout << "release" << endl;
-                    break;
-                }
-                case XK_Left:
-                {
-                    xInfo.keyPressedBool = false;
-                    // cout << "release" << endl;
+                    sendCommand(SIM_TURN, INPUT_WEST);
                     break;
                 }
             }
@@ -784,137 +679,156 @@ void keyPressInput(XInfo &xInfo, XEvent &event)
 }
 
 /*
- * Execute animation of snake.
+ * Block until the X connection has input, the simulation has a new
+ * screen to show, or the deadline, in microseconds on the now()
+ * clock, has passed. A deadline of zero waits for input only.
  */
-void handleAnimation(XInfo &xInfo)
+void waitForEvents(XInfo &xInfo, unsigned long deadline)
 {
-    if (!gamePaused && alive)
+    // Send any buffered requests, and don't sleep on events that
+    // Xlib has already read off the connection.
+    if (XPending(xInfo.display) > 0)
     {
-        snake.move(xInfo);
+        return;
     }
-}
-
-/*
- * Function to draw displayables to the window.
- */
-void repaint(XInfo &xInfo)
-{
-    // list<Displayable *> dList1;
-    // list<Displayable *> dList2;
-
-    string ss1 = "Game Paused";
-    string ss2 = "Press p again to resume or q to quit.";
 
-    string ss3 = "Game Over";
-    string ss4 = "Press Spacebar to re-start or q to quit.";
+    int fd = ConnectionNumber(xInfo.display);
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(fd, &readSet);
+    FD_SET(renderPipe[0], &readSet);
 
-    dList1.push_front(new Text(SCREEN_WIDTH/2 - 3*ss1.length(), SCREEN_HEIGHT/2 - 25, ss1));
-    dList1.push_front(new Text(SCREEN_WIDTH/2 - 3*ss2.length(), SCREEN_HEIGHT/2, ss2));
-
-    dList2.push_front(new Text(SCREEN_WIDTH/2 - 3*ss1.length(), SCREEN_HEIGHT/2 - 25, ss3));
-    dList2.push_front(new Text(SCREEN_WIDTH/2 - 3*ss2.length(), SCREEN_HEIGHT/2, ss4));
-
-    if (!gamePaused && alive)
+    timeval timeout;
+    timeval * timeoutPtr = NULL;
+    if (deadline != 0)
     {
-        list<Displayable *>::const_iterator begin = dList.begin();
-        list<Displayable *>::const_iterator end = dList.end();
+        unsigned long current = now();
+        unsigned long remaining = (deadline > current) ? deadline - current : 0;
+        timeout.tv_sec = remaining/1000000;
+        timeout.tv_usec = remaining%1000000;
+        timeoutPtr = &timeout;
+    }
 
-        XClearWindow(xInfo.display, xInfo.window);
-        while(begin != end)
+    // An interrupted wait simply returns to the event loop.
+    TraceSpan span("wait");
+    if (select(max(fd, renderPipe[0]) + 1, &readSet, NULL, NULL, timeoutPtr) > 0
+        && FD_ISSET(renderPipe[0], &readSet))
+    {
+        char bytes[64];
+        while (read(renderPipe[0], bytes, sizeof(bytes)) > 0)
         {
-            // Note: Here a pointer is set to the value pointed to by
-            // begin, which is the address contained in dList.
-            Displayable * d = *begin;
-            d->paint(xInfo);
-            begin++;
         }
-        XFlush(xInfo.display);
     }
-    else if (gamePaused)
+}
+
+/*
+ * Handle every event that has arrived.
+ */
+void handleEvents(XInfo &xInfo)
+{
+    ScopedTimer timer(perfStats, PERF_EVENTS);
+    TraceSpan span("input");
+    XEvent event;
+    while (XPending(xInfo.display) > 0)
     {
-        list<Displayable *>::const_iterator begin1 = dList1.begin();
-        list<Displayable *>::const_iterator end1 = dList1.end();
-        
-        XClearWindow(xInfo.display, xInfo.window);
-        while(begin1 != end1)
+        XNextEvent(xInfo.display, &event);
+
+        // Recreate the back buffer when the window is resized.
+        if (event.type == ConfigureNotify
+            && (event.xconfigure.width != xInfo.width
+                || event.xconfigure.height != xInfo.height))
         {
-            Displayable * d1 = *begin1;
-            d1->paint(xInfo);
-            begin1++;
+            createBuffer(xInfo, event.xconfigure.width, event.xconfigure.height);
+            damage.full = true;
         }
-        XFlush(xInfo.display);
-    }
-    else if (!alive)
-    {
-        list<Displayable *>::const_iterator begin2 = dList2.begin();
-        list<Displayable *>::const_iterator end2 = dList2.end();
 
-        XClearWindow(xInfo.display, xInfo.window);
-        while(begin2 != end2)
+        // Restore the window contents after it is uncovered.
+        if (event.type == Expose && event.xexpose.count == 0)
         {
-            Displayable * d2 = *begin2;
-            d2->paint(xInfo);
-            begin2++;
+            damage.full = true;
         }
-        XFlush(xInfo.display);
+
+        // Decide action required based on keyPress input.
+        keyPressInput(event);
     }
 }
 
 /*
- * Execute event loop.
+ * Execute event loop. The game runs on the simulation thread; this
+ * thread handles X events and draws the frames it publishes.
  */ 
 void eventLoop(XInfo &xInfo)
 {
     // Show splash page initially.
+    initScenes();
     if (showSplash)
     {
-        string s1 = "Snake!";
-        string s2 = "Created by: Christopher Mannes";
-        string s3 = "Press left, right, up, and down arrow keys to direct the snake.";
-        string s4 = "Press p to pause, q to quit, and spacebar to start.";
-
-        dList.push_front(new Text(SCREEN_WIDTH/2 - 3*s1.length(), SCREEN_HEIGHT/2 - 25, s1));
-        dList.push_front(new Text(SCREEN_WIDTH/2 - 3*s2.length(), SCREEN_HEIGHT/2, s2));
-        dList.push_front(new Text(SCREEN_WIDTH/2 - 3*s3.length(), SCREEN_HEIGHT/2 + 25, s3));
-        dList.push_front(new Text(SCREEN_WIDTH/2 - 3*s4.length(), SCREEN_HEIGHT/2 + 50, s4));
+        dList.push_front(&splashScene);
     }
 
-    XEvent event;
-    xInfo.keyPressedBool = false;
-    unsigned long lastUpdate = now();
+    damage.full = true;
+    unsigned long frameInterval = 1000000/FPS;
     unsigned long lastRepaint = 0;
+    unsigned long lastHud = 0;
+    unsigned long lastTick = 0;
 
     while (true)
     {
-        if (XPending(xInfo.display) > 0)
-        {
-            XNextEvent(xInfo.display, &event);
-
-            // Decide action required based on keyPress input.
-            keyPressInput(xInfo, event);
-        }
+        // Dropped frames only count if the game was running.
+        bool wasRunning = (currentFrameMode() == PLAY_FRAME);
 
+        // Handle every event that has arrived, then pick up the
+        // latest state of the game.
+        handleEvents(xInfo);
+        takeFrame(lastTick);
         unsigned long end = now();
-        xInfo.deltaTime = (end - lastUpdate);
 
-        // Update snake state.
-        if (!showSplash && !gamePaused)
+        // How far the head has moved towards the next cell.
+        xInfo.accumulator = (end > lastTick) ? end - lastTick : 0;
+        if (xInfo.accumulator > xInfo.tickInterval)
+        {
+            xInfo.accumulator = xInfo.tickInterval;
+        }
+
+        // Refresh the HUD figures now and then.
+        if (perfStats.isEnabled() && end - lastHud >= HUD_INTERVAL)
         {
-            handleAnimation(xInfo);
+            damage.info |= hudText.setText(perfStats.summary());
+            lastHud = end;
         }
 
-        lastUpdate = now();
-        if (end - lastRepaint > 1000000/FPS)
+        // Repaint when a frame is due, or straight away when the
+        // screen has changed.
+        bool playing = (currentFrameMode() == PLAY_FRAME);
+        if (damage.full || currentFrameMode() != damage.mode
+            || (playing && end - lastRepaint >= frameInterval))
         {
-            // handleAnimation(xInfo);
+            // Frames that were due while the game ran but never drawn.
+            if (perfStats.isEnabled() && wasRunning && playing
+                && end - lastRepaint >= 2*frameInterval)
+            {
+                perfStats.dropFrames((end - lastRepaint)/frameInterval - 1);
+            }
+
+            ScopedTimer timer(perfStats, PERF_REPAINT);
+            TraceSpan span("repaint");
             repaint(xInfo);
-            lastRepaint = now();
+            lastRepaint = end;
         }
 
-        // IMPORTANT: sleep for a bit to let other processes work.
-        if (XPending(xInfo.display) == 0)
+        // Sleep until the next frame is due, or until input or a new
+        // screen arrives. Nothing is due while the game is not running.
+        unsigned long deadline = playing ? lastRepaint + frameInterval : 0;
+        waitForEvents(xInfo, deadline);
+
+        // How late the wait ended past its deadline.
+        if (perfStats.isEnabled() && deadline != 0)
         {
-            usleep(1000000 / FPS - (now() - lastRepaint));
+            unsigned long woke = now();
+            if (woke > deadline)
+            {
+                perfStats.record(PERF_OVERSHOOT, woke - deadline);
+            }
         }
     }
 }
@@ -928,20 +842,137 @@ void eventLoop(XInfo &xInfo)
 int main(int argc, char * argv[]) {
 
     // Read command-line parameters.
-    if (argc == 1)
+    double ticksPerSecond = speedArrray[DEFAULT_SPEED];
+    uint64_t seed = now();
+    string recordPath;
+    RendererType renderer = PRIMITIVE_RENDERER;
+    int boardWidth = BOARD_WIDTH;
+    int boardHeight = BOARD_HEIGHT;
+    for (int i = 1; i < argc; i++)
     {
-        xInfo.snakeSpeed = 50*speedArrray[2];
+        string arg = argv[i];
+        if (arg == "--ticks" && i + 1 < argc)
+        {
+            ticksPerSecond = atof(argv[++i]);
+            if (ticksPerSecond <= 0)
+            {
+                error("Invalid inputs. Ticks per second must be positive.");
+            }
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (arg == "--stats")
+        {
+            perfStats.enable();
+        }
+        else if (arg == "--hud")
+        {
+            perfStats.enable();
+            hudText.show();
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+            startTracing();
+            traceThreadName("X");
+        }
+        else if (arg == "--board" && i + 1 < argc)
+        {
+            if (!parseBoardSize(argv[++i], boardWidth, boardHeight))
+            {
+                error("Invalid inputs. Board must be WIDTHxHEIGHT, each side at most 65536.");
+            }
+        }
+        else if (arg == "--renderer" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            if (name == "primitive")
+            {
+                renderer = PRIMITIVE_RENDERER;
+            }
+            else if (name == "framebuffer")
+            {
+                renderer = FRAMEBUFFER_RENDERER;
+            }
+            else
+            {
+                error("Invalid inputs. Renderer must be primitive or framebuffer.");
+            }
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            if (!player.open(argv[++i]))
+            {
+                error("Cannot read replay file.");
+            }
+            replaying = true;
+        }
+        else if (arg == "--autopilot")
+        {
+            autopilotEnabled = true;
+        }
+        else if (arg.length() == 1 && arg[0] >= '0' && arg[0] <= '4')
+        {
+            ticksPerSecond = speedArrray[arg[0] - '0'];
+        }
+        else
+        {
+            error("Invalid inputs. Usage: snakeGame [0-4] [--ticks N] [--seed N] [--board WxH] "
+                  "[--record FILE | --replay FILE] [--autopilot] [--stats] [--hud] [--trace FILE] "
+                  "[--renderer primitive|framebuffer]");
+        }
     }
-    else if (argc == 2)
+
+    xInfo.tickInterval = 1000000/ticksPerSecond;
+    if (xInfo.tickInterval == 0)
     {
-        xInfo.snakeSpeed = speedArrray[stoi(argv[1])];
+        xInfo.tickInterval = 1;
     }
-    else if (argc > 2)
+
+    // Start the game from the chosen seed, or from the replay at the
+    // speed it was recorded at.
+    if (replaying)
     {
-        error("Invalid inputs. Only zero or one arguments allowed.");
+        xInfo.tickInterval = player.getHeader().tickInterval;
+        player.start(simGame);
+    }
+    else
+    {
+        cout << "Seed: " << seed << endl;
+        simGame.resize(boardWidth, boardHeight);
+        simGame.restart(seed);
+        if (!recordPath.empty()
+            && !recorder.open(recordPath, seed, xInfo.tickInterval, boardWidth, boardHeight))
+        {
+            error("Cannot write replay file.");
+        }
     }
 
 	initXWindow(argc, argv, xInfo);
+    if (initRenderer(xInfo, renderer) != renderer)
+    {
+        cerr << "Framebuffer needs 32-bit pixels: using the primitive renderer." << endl;
+    }
+    else if (renderer == FRAMEBUFFER_RENDERER && !xInfo.frameBuffer->isShared())
+    {
+        cerr << "MIT-SHM unavailable: presenting the framebuffer with XPutImage." << endl;
+    }
+
+    // Start the simulation, with a pipe it can wake this thread with.
+    if (pipe(renderPipe) != 0)
+    {
+        error("Cannot create pipe.");
+    }
+    fcntl(renderPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(renderPipe[1], F_SETFL, O_NONBLOCK);
+    simThread = thread(simulationLoop);
+
 	eventLoop(xInfo);
 	XCloseDisplay(xInfo.display);
 
@@ -0,0 +1,845 @@
+/*
+Headless driver for running Snake games without an X server.
+
+Running the command "make sim" in the command-line in the working
+directory will build the snakeSim executable.
+
+Modes:
+
+    ./snakeSim batch [games] [steps]
+        Step a batch of games with random moves and report the
+        number of game steps per second.
+
+    ./snakeSim tournament [games] [threads]
+        Play the given number of games for every policy and speed
+        setting, spread across all cores (or the given number of
+        threads), and report throughput and score distributions.
+
+    ./snakeSim check [games]
+        Play games with every policy on each board size that has a
+        fixed-size specialization, on it and on the general board side
+        by side with the same inputs, and report any tick where the
+        two differ. Exits with status 1 if any game differs.
+
+    ./snakeSim record FILE [policy] [speed]
+        Play one game with a policy (random, greedy or autopilot)
+        and save it as a replay.
+
+    ./snakeSim replay FILE [tick]
+        Play a replay back as fast as possible, starting from the
+        given tick, and report how the game ended.
+
+    ./snakeSim pack CORPUS FILE...
+        Pack replay files into one corpus file (see replayCorpus.h).
+
+    ./snakeSim scan CORPUS [threads]
+        Play back every game in a corpus across all cores (or the
+        given number of threads) and report how the games ended.
+
+    ./snakeSim render FILE OUTPUT [cell] [every]
+        Draw a replay into images, one frame per tick (or every given
+        number of ticks) with cells of the given size in pixels. An
+        OUTPUT ending in ".y4m", or "-" for standard output, is
+        written as a y4m video stream; any other OUTPUT is a prefix
+        for numbered PPM images. Figures are reported on standard
+        error.
+
+Every mode takes "--seed N" to choose the games that are played; the
+same seed always plays the same games. "--board WxH" plays tournament
+and record games on a board of the given size in cells instead of the
+default 40x37; batches keep dense per-game arrays and always use the
+default, and replays keep the size they were recorded on. Tournament
+games on 10x10, 20x20 and 40x37 boards run on a board specialized for
+that size at compile time (see fixedGame.h); "--generic" plays them on
+the general board instead, with the same results. "--trace FILE" writes a
+timeline of the games played on each thread, and of fruit placement,
+as JSON for chrome://tracing or Perfetto. An error is displayed if any
+other argument format is given, or if a file cannot be read or
+written, and the program exits with status 1.
+*/
+
+// Import header files.
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <time.h>
+#include <stdint.h>
+
+// Headless game state.
+#include "gameState.h"
+#include "fixedGame.h"
+#include "batchGame.h"
+#include "policy.h"
+#include "autopilot.h"
+#include "workStealing.h"
+#include "random.h"
+#include "replay.h"
+#include "replayCorpus.h"
+#include "tracer.h"
+#include "offscreenView.h"
+#include "frameEncoder.h"
+
+using namespace std;
+
+// Default batch size and length.
+const int DEFAULT_BATCH_GAMES = 1024;
+const long DEFAULT_BATCH_STEPS = 10000;
+
+// Number of pre-generated random action rows cycled through.
+const int ACTION_ROWS = 64;
+
+// Default tournament size: games per policy and speed.
+const int DEFAULT_TOURNAMENT_GAMES = 200;
+
+// Default number of games per policy and board in a check.
+const int DEFAULT_CHECK_GAMES = 20;
+
+// Game time, in seconds at the game's speed, before a game that
+// has not died is stopped.
+const double GAME_TIME_LIMIT = 600;
+
+// Seed used when none is given.
+const uint64_t DEFAULT_SEED = 1;
+
+// Size of the board games are played on, set with --board.
+int boardWidth = BOARD_WIDTH;
+int boardHeight = BOARD_HEIGHT;
+
+// Whether tournament games skip the fixed-size boards, set with
+// --generic.
+bool genericBoard = false;
+
+const char * USAGE = "Invalid inputs. Usage: snakeSim [--seed N] [--board WxH] [--generic] "
+                     "[--trace FILE] "
+                     "batch [games] [steps] | tournament [games] [threads] | check [games] | "
+                     "record FILE [policy] [speed] | replay FILE [tick] | "
+                     "pack CORPUS FILE... | scan CORPUS [threads] | "
+                     "render FILE OUTPUT [cell] [every]";
+
+/*
+ * The outcome of one tournament game.
+ */
+struct GameResult {
+    int policy;
+    int speed;
+    int score;
+    long ticks;
+};
+
+/*
+ * One game found in a replay corpus. A replay holds more than one
+ * game when the player restarted.
+ */
+struct ReplayGame {
+    int score;
+    int length;
+    DeathCause death;
+    long ticks;
+};
+
+void error(string str)
+{
+    // Output error message.
+    cerr << str << endl;
+
+    // Exit application, reporting the failure.
+    exit(1);
+}
+
+// Get current time in seconds from a clock that never jumps.
+double seconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/*
+ * Step a batch of games with random moves and report throughput.
+ */
+void runBatch(int games, long steps, uint64_t seed)
+{
+    BatchGame batch(games, BOARD_WIDTH, BOARD_HEIGHT, seed);
+
+    // Pre-generate random moves so timing covers only the games.
+    // Most rows keep going straight.
+    Random random(~seed);
+    vector<uint8_t> actions((size_t)ACTION_ROWS*games);
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+        int r = random.below(8);
+        actions[i] = (r < 4) ? INPUT_NONE : r - 3;
+    }
+
+    long finished = 0;
+    long totalScore = 0;
+    double start = seconds();
+    for (long s = 0; s < steps; s++)
+    {
+        batch.step(&actions[(size_t)(s % ACTION_ROWS)*games]);
+
+        const uint8_t *done = batch.getDone();
+        const int32_t *finalScore = batch.getFinalScore();
+        for (int i = 0; i < games; i++)
+        {
+            if (done[i])
+            {
+                finished++;
+                totalScore += finalScore[i];
+            }
+        }
+    }
+    double elapsed = seconds() - start;
+
+    cout << "games: " << games << endl;
+    cout << "steps: " << steps << endl;
+    cout << "finished: " << finished << endl;
+    cout << "mean score: " << (finished ? (double)totalScore/finished : 0) << endl;
+    cout << "steps/sec: " << (long)(games*(double)steps/elapsed) << endl;
+}
+
+/*
+ * Play a game to the end, or until its time limit, with a policy.
+ * The policy is called directly rather than through Policy so it is
+ * compiled together with each kind of game.
+ */
+template <class Game>
+GameResult playPolicy(Game &game, int policy, int speed, uint64_t seed)
+{
+    RandomPolicy randomPolicy(~seed);
+    GreedyPolicy greedyPolicy;
+    AutopilotPolicy autopilot;
+
+    long maxTicks = GAME_TIME_LIMIT*speedArrray[speed];
+    long ticks = 0;
+    while (game.isAlive() && ticks < maxTicks)
+    {
+        Input input;
+        switch (policy)
+        {
+            case RANDOM_POLICY: input = randomPolicy.pick(game); break;
+            case GREEDY_POLICY: input = greedyPolicy.pick(game); break;
+            default:            input = autopilot.pick(game); break;
+        }
+        game.step(input);
+        ticks++;
+    }
+
+    GameResult result = {policy, speed, game.getScore(), ticks};
+    return result;
+}
+
+/*
+ * Play one tournament game on the board chosen with --board.
+ */
+GameResult playGame(int policy, int speed, uint64_t seed)
+{
+    GameResult result;
+    withBoard(boardWidth, boardHeight, seed, genericBoard, [&](auto &game)
+    {
+        result = playPolicy(game, policy, speed, seed);
+    });
+    return result;
+}
+
+/*
+ * Whether a fixed-size game is in the same state as a general one:
+ * the same status and fruit, the same body cell for cell, and the
+ * same occupancy of every cell the general one's last step changed,
+ * which catches a cell left covered behind the tail.
+ */
+template <int WIDTH, int HEIGHT>
+bool sameGame(const FixedGame<WIDTH, HEIGHT> &fixed, const GameState &general)
+{
+    Cell fruit = general.getFruit();
+    Cell fixedFruit = fixed.getFruit();
+    if (fixed.isAlive() != general.isAlive() || fixed.getScore() != general.getScore()
+        || fixed.getDeathCause() != general.getDeathCause()
+        || fixed.getDirection() != general.getDirection()
+        || fixed.getBody().size() != general.getBody().size()
+        || fixedFruit.x != fruit.x || fixedFruit.y != fruit.y)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < general.getBody().size(); i++)
+    {
+        Cell cell = general.getBody()[i];
+        Cell fixedCell = fixed.getBody()[i];
+        if (fixedCell.x != cell.x || fixedCell.y != cell.y)
+        {
+            return false;
+        }
+    }
+    const vector<Cell> &changed = general.getChangedCells();
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        if (fixed.covers(changed[i]) != general.covers(changed[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Play games on a fixed-size board and on a general one of the same
+ * size in lockstep, the policy choosing from the general one, and
+ * compare them after every tick. Returns the number of games that
+ * differed.
+ */
+template <int WIDTH, int HEIGHT>
+int checkBoard(int games, uint64_t seed)
+{
+    int mismatches = 0;
+    long totalTicks = 0;
+    long maxTicks = GAME_TIME_LIMIT*speedArrray[SPEED_COUNT - 1];
+    for (int policy = 0; policy < POLICY_COUNT; policy++)
+    {
+        for (int g = 0; g < games; g++)
+        {
+            uint64_t gameSeed = seed + g;
+            FixedGame<WIDTH, HEIGHT> fixed(gameSeed);
+            GameState general(gameSeed, WIDTH, HEIGHT);
+            RandomPolicy randomPolicy(~gameSeed);
+            GreedyPolicy greedyPolicy;
+            AutopilotPolicy autopilot;
+            Policy * players[POLICY_COUNT] = {&randomPolicy, &greedyPolicy, &autopilot};
+
+            for (long ticks = 0; ticks <= maxTicks; ticks++)
+            {
+                if (!sameGame(fixed, general))
+                {
+                    cout << WIDTH << "x" << HEIGHT << " " << policyName((PolicyType)policy)
+                         << " seed " << gameSeed << ": differs at tick " << ticks << endl;
+                    mismatches++;
+                    break;
+                }
+                if (!general.isAlive() || ticks == maxTicks)
+                {
+                    totalTicks += ticks;
+                    break;
+                }
+
+                Input input = players[policy]->choose(general);
+                fixed.step(input);
+                general.step(input);
+            }
+        }
+    }
+    cout << WIDTH << "x" << HEIGHT << "\tgames: " << games*POLICY_COUNT << "\tticks: "
+         << totalTicks << "\tdiffering: " << mismatches << endl;
+    return mismatches;
+}
+
+/*
+ * Check every fixed-size board against the general one.
+ */
+int runCheck(int games, uint64_t seed)
+{
+    return checkBoard<10, 10>(games, seed) + checkBoard<20, 20>(games, seed)
+           + checkBoard<BOARD_WIDTH, BOARD_HEIGHT>(games, seed);
+}
+
+// Score at the given fraction of a sorted list.
+int percentile(const vector<int> &sorted, double fraction)
+{
+    size_t i = fraction*(sorted.size() - 1);
+    return sorted[i];
+}
+
+/*
+ * Play games for every policy and speed across all cores and report
+ * throughput and score distributions.
+ */
+void runTournament(int gamesPerEntry, int threads, uint64_t seed)
+{
+    int entries = POLICY_COUNT*SPEED_COUNT;
+    int jobCount = gamesPerEntry*entries;
+
+    // Each job writes only its own result, so workers share nothing.
+    vector<GameResult> results(jobCount);
+    WorkStealingScheduler scheduler(threads);
+
+    double start = seconds();
+    scheduler.run(jobCount, [&results, entries, seed](int job, int)
+    {
+        TraceSpan span("game");
+        int entry = job % entries;
+        results[job] = playGame(entry / SPEED_COUNT, entry % SPEED_COUNT, seed + job);
+    });
+    double elapsed = seconds() - start;
+
+    long totalTicks = 0;
+    for (int j = 0; j < jobCount; j++)
+    {
+        totalTicks += results[j].ticks;
+    }
+
+    cout << "threads: " << scheduler.size() << endl;
+    cout << "games: " << jobCount << endl;
+    cout << "seconds: " << elapsed << endl;
+    cout << "games/sec: " << (long)(jobCount/elapsed) << endl;
+    cout << "ticks/sec: " << (long)(totalTicks/elapsed) << endl;
+    cout << endl;
+    cout << "policy\tspeed\tgames\tmean\tp50\tp90\tp99\tmax\tticks" << endl;
+
+    for (int policy = 0; policy < POLICY_COUNT; policy++)
+    {
+        for (int speed = 0; speed < SPEED_COUNT; speed++)
+        {
+            vector<int> scores;
+            long ticks = 0;
+            for (int j = 0; j < jobCount; j++)
+            {
+                if (results[j].policy == policy && results[j].speed == speed)
+                {
+                    scores.push_back(results[j].score);
+                    ticks += results[j].ticks;
+                }
+            }
+            sort(scores.begin(), scores.end());
+
+            long total = 0;
+            for (size_t i = 0; i < scores.size(); i++)
+            {
+                total += scores[i];
+            }
+            cout << policyName((PolicyType)policy) << "\t" << speed << "\t"
+                 << scores.size() << "\t" << (double)total/scores.size() << "\t"
+                 << percentile(scores, 0.5) << "\t" << percentile(scores, 0.9) << "\t"
+                 << percentile(scores, 0.99) << "\t" << scores.back() << "\t"
+                 << ticks/(long)scores.size() << endl;
+        }
+    }
+}
+
+/*
+ * Play one game with a policy and save it as a replay.
+ */
+void runRecord(const string &path, int policy, int speed, uint64_t seed)
+{
+    ReplayRecorder recorder;
+    if (!recorder.open(path, seed, 1000000/speedArrray[speed], boardWidth, boardHeight))
+    {
+        error("Cannot open replay file " + path + ".");
+    }
+
+    GameState game(seed, boardWidth, boardHeight);
+    RandomPolicy randomPolicy(~seed);
+    GreedyPolicy greedyPolicy;
+    AutopilotPolicy autopilot;
+    Policy * players[POLICY_COUNT] = {&randomPolicy, &greedyPolicy, &autopilot};
+    Policy * player = players[policy];
+
+    long maxTicks = GAME_TIME_LIMIT*speedArrray[speed];
+    long ticks = 0;
+    while (game.isAlive() && ticks < maxTicks)
+    {
+        Input input = player->choose(game);
+        recorder.step(game, input);
+        game.step(input);
+        ticks++;
+    }
+    if (!recorder.close())
+    {
+        error("Cannot write replay file " + path + ".");
+    }
+
+    cout << "ticks: " << ticks << endl;
+    cout << "score: " << game.getScore() << endl;
+}
+
+/*
+ * Play a replay back as fast as possible from a tick.
+ */
+void runReplay(const string &path, long startTick)
+{
+    ReplayPlayer player;
+    if (!player.open(path))
+    {
+        error("Cannot read replay file " + path + ".");
+    }
+
+    GameState game;
+    double start = seconds();
+    player.start(game);
+    player.seek(game, startTick);
+    long ticks = player.getTick();
+    while (player.step(game))
+    {
+    }
+    double elapsed = seconds() - start;
+
+    cout << "seed: " << player.getHeader().seed << endl;
+    cout << "ticks: " << player.getLength() << endl;
+    cout << "score: " << game.getScore() << endl;
+    cout << "length: " << game.getBody().size() << endl;
+    cout << "alive: " << game.isAlive() << endl;
+    cout << "ticks/sec: " << (long)((player.getLength() - ticks)/elapsed) << endl;
+}
+
+/*
+ * Pack replay files into a corpus.
+ */
+void runPack(const string &path, const vector<string> &files)
+{
+    ReplayCorpusWriter writer;
+    if (!writer.open(path))
+    {
+        error("Cannot open corpus file " + path + ".");
+    }
+
+    vector<uint8_t> bytes;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        ifstream in(files[i].c_str(), ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        if (!in.is_open() || bytes.empty() || !writer.add(&bytes[0], bytes.size()))
+        {
+            error("Cannot read replay file " + files[i] + ".");
+        }
+    }
+    if (!writer.close())
+    {
+        error("Cannot write corpus file " + path + ".");
+    }
+
+    cout << "replays: " << files.size() << endl;
+}
+
+// Short name of how a game ended for reports.
+const char * deathCauseName(DeathCause death)
+{
+    switch (death)
+    {
+        case DEATH_NONE: return "running";
+        case DEATH_WALL: return "wall";
+        case DEATH_SELF: return "self";
+        case DEATH_BOARD_FULL: return "full";
+    }
+    return "unknown";
+}
+
+/*
+ * Play back every replay in a corpus across all cores and report how
+ * the games in them ended.
+ */
+void runScan(const string &path, int threads)
+{
+    ReplayCorpus corpus;
+    if (!corpus.open(path))
+    {
+        error("Cannot read corpus file " + path + ".");
+    }
+
+    // Every worker reuses its own game and player, and collects the
+    // games it plays in its own list.
+    WorkStealingScheduler scheduler(threads);
+    int workers = scheduler.size();
+    vector<GameState> games(workers);
+    vector<ReplayPlayer> players(workers);
+    vector<vector<ReplayGame> > found(workers);
+    vector<long> invalid(workers);
+    vector<long> ticks(workers);
+
+    double start = seconds();
+    scheduler.run(corpus.size(), [&](int job, int worker)
+    {
+        GameState &game = games[worker];
+        ReplayPlayer &player = players[worker];
+        if (!player.load(corpus.recordData(job), corpus.recordSize(job)))
+        {
+            invalid[worker]++;
+            return;
+        }
+
+        player.start(game);
+        long gameStart = 0;
+        bool wasAlive = true;
+        while (player.step(game))
+        {
+            if (player.restarted())
+            {
+                gameStart = player.getTick() - 1;
+            }
+            if (wasAlive && !game.isAlive())
+            {
+                ReplayGame result = {game.getScore(), (int)game.getBody().size(),
+                                     game.getDeathCause(), player.getTick() - gameStart};
+                found[worker].push_back(result);
+            }
+            wasAlive = game.isAlive();
+        }
+
+        // A replay stopped part way through a game.
+        if (game.isAlive())
+        {
+            ReplayGame result = {game.getScore(), (int)game.getBody().size(),
+                                 DEATH_NONE, player.getTick() - gameStart};
+            found[worker].push_back(result);
+        }
+        ticks[worker] += player.getLength();
+    });
+    double elapsed = seconds() - start;
+
+    long totalTicks = 0;
+    long totalInvalid = 0;
+    vector<ReplayGame> all;
+    for (int w = 0; w < workers; w++)
+    {
+        totalTicks += ticks[w];
+        totalInvalid += invalid[w];
+        all.insert(all.end(), found[w].begin(), found[w].end());
+    }
+
+    cout << "threads: " << workers << endl;
+    cout << "replays: " << corpus.size() << endl;
+    cout << "invalid: " << totalInvalid << endl;
+    cout << "games: " << all.size() << endl;
+    cout << "seconds: " << elapsed << endl;
+    cout << "MB/sec: " << corpus.bytes()/elapsed/1e6 << endl;
+    cout << "ticks/sec: " << (long)(totalTicks/elapsed) << endl;
+    cout << endl;
+    cout << "end	games	mean	p50	p90	p99	max	length	ticks" << endl;
+
+    for (int death = DEATH_NONE; death <= DEATH_BOARD_FULL; death++)
+    {
+        vector<int> scores;
+        long length = 0;
+        long gameTicks = 0;
+        for (size_t i = 0; i < all.size(); i++)
+        {
+            if (all[i].death == death)
+            {
+                scores.push_back(all[i].score);
+                length += all[i].length;
+                gameTicks += all[i].ticks;
+            }
+        }
+        if (scores.empty())
+        {
+            continue;
+        }
+        sort(scores.begin(), scores.end());
+
+        long total = 0;
+        for (size_t i = 0; i < scores.size(); i++)
+        {
+            total += scores[i];
+        }
+        long n = scores.size();
+        cout << deathCauseName((DeathCause)death) << "\t" << n << "\t"
+             << (double)total/n << "\t" << percentile(scores, 0.5) << "\t"
+             << percentile(scores, 0.9) << "\t" << percentile(scores, 0.99) << "\t"
+             << scores.back() << "\t" << (double)length/n << "\t"
+             << gameTicks/n << endl;
+    }
+}
+
+/*
+ * Draw a replay into a PPM sequence or y4m stream, drawing on this
+ * thread while the frames are written on another.
+ */
+void runRender(const string &path, const string &output, int cellSize, long every)
+{
+    ReplayPlayer player;
+    if (!player.open(path))
+    {
+        error("Cannot read replay file " + path + ".");
+    }
+
+    bool stream = (output == "-"
+                   || (output.length() > 4 && output.compare(output.length() - 4, 4, ".y4m") == 0));
+    // Frames show a board up to the size of the game window, and a
+    // scrolling view of a larger one.
+    const ReplayHeader &header = player.getHeader();
+    OffscreenView view(cellSize, min(header.width, BOARD_WIDTH), min(header.height, BOARD_HEIGHT));
+    FrameEncoder encoder;
+    if (!encoder.open(stream ? Y4M_STREAM : PPM_SEQUENCE, output, view.getWidth(), view.getHeight(),
+                      1000000, header.tickInterval*every))
+    {
+        error("Cannot write " + output + ".");
+    }
+
+    // Keep one image up to date tick by tick, and copy it out for
+    // each frame.
+    double start = seconds();
+    GameState game;
+    RgbImage canvas;
+    player.start(game);
+    view.paintAll(game, canvas);
+    encoder.nextFrame() = canvas;
+    encoder.submit();
+    while (player.step(game))
+    {
+        TraceSpan span("draw");
+        if (player.restarted())
+        {
+            view.paintAll(game, canvas);
+        }
+        else
+        {
+            view.paintChanged(game, canvas);
+        }
+        if (player.getTick() % every == 0)
+        {
+            encoder.nextFrame() = canvas;
+            encoder.submit();
+        }
+    }
+    if (!encoder.close())
+    {
+        error("Cannot write " + output + ".");
+    }
+    double elapsed = seconds() - start;
+
+    cerr << "ticks: " << player.getLength() << endl;
+    cerr << "frames: " << encoder.getFrameCount() << endl;
+    cerr << "size: " << view.getWidth() << "x" << view.getHeight() << endl;
+    cerr << "frames/sec: " << (long)(encoder.getFrameCount()/elapsed) << endl;
+}
+
+// Policy index from its name.
+int parsePolicy(const string &name)
+{
+    for (int policy = 0; policy < POLICY_COUNT; policy++)
+    {
+        if (name == policyName((PolicyType)policy))
+        {
+            return policy;
+        }
+    }
+    error("Invalid inputs. Unknown policy " + name + ".");
+    return 0;
+}
+
+/*
+ * Enter main program.
+ */
+int main(int argc, char * argv[])
+{
+    // Pull out the options shared by every mode.
+    uint64_t seed = DEFAULT_SEED;
+    string tracePath;
+    vector<string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+            startTracing();
+        }
+        else if (arg == "--board" && i + 1 < argc)
+        {
+            if (!parseBoardSize(argv[++i], boardWidth, boardHeight))
+            {
+                error("Invalid inputs. Board must be WIDTHxHEIGHT, each side at most 65536.");
+            }
+        }
+        else if (arg == "--generic")
+        {
+            genericBoard = true;
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.empty())
+    {
+        error(USAGE);
+    }
+
+    string mode = args[0];
+    if (mode == "batch" && args.size() <= 3)
+    {
+        int games = (args.size() > 1) ? atoi(args[1].c_str()) : DEFAULT_BATCH_GAMES;
+        long steps = (args.size() > 2) ? atol(args[2].c_str()) : DEFAULT_BATCH_STEPS;
+        if (games <= 0 || steps <= 0)
+        {
+            error("Invalid inputs. Games and steps must be positive.");
+        }
+        runBatch(games, steps, seed);
+    }
+    else if (mode == "tournament" && args.size() <= 3)
+    {
+        int games = (args.size() > 1) ? atoi(args[1].c_str()) : DEFAULT_TOURNAMENT_GAMES;
+        int threads = (args.size() > 2) ? atoi(args[2].c_str()) : 0;
+        if (games <= 0 || threads < 0)
+        {
+            error("Invalid inputs. Games must be positive.");
+        }
+        runTournament(games, threads, seed);
+    }
+    else if (mode == "check" && args.size() <= 2)
+    {
+        int games = (args.size() > 1) ? atoi(args[1].c_str()) : DEFAULT_CHECK_GAMES;
+        if (games <= 0)
+        {
+            error("Invalid inputs. Games must be positive.");
+        }
+        if (runCheck(games, seed) != 0)
+        {
+            return(1);
+        }
+    }
+    else if (mode == "record" && args.size() >= 2 && args.size() <= 4)
+    {
+        int policy = (args.size() > 2) ? parsePolicy(args[2]) : GREEDY_POLICY;
+        int speed = (args.size() > 3) ? atoi(args[3].c_str()) : DEFAULT_SPEED;
+        if (speed < 0 || speed >= SPEED_COUNT)
+        {
+            error("Invalid inputs. Speed must be in the range [0-4].");
+        }
+        runRecord(args[1], policy, speed, seed);
+    }
+    else if (mode == "replay" && args.size() >= 2 && args.size() <= 3)
+    {
+        long tick = (args.size() > 2) ? atol(args[2].c_str()) : 0;
+        runReplay(args[1], tick);
+    }
+    else if (mode == "pack" && args.size() >= 3)
+    {
+        runPack(args[1], vector<string>(args.begin() + 2, args.end()));
+    }
+    else if (mode == "scan" && args.size() >= 2 && args.size() <= 3)
+    {
+        int threads = (args.size() > 2) ? atoi(args[2].c_str()) : 0;
+        if (threads < 0)
+        {
+            error("Invalid inputs. Threads must not be negative.");
+        }
+        runScan(args[1], threads);
+    }
+    else if (mode == "render" && args.size() >= 3 && args.size() <= 5)
+    {
+        int cell = (args.size() > 3) ? atoi(args[3].c_str()) : DEFAULT_CELL_PIXELS;
+        long every = (args.size() > 4) ? atol(args[4].c_str()) : 1;
+        if (cell <= 0 || every <= 0)
+        {
+            error("Invalid inputs. Cell size and frame interval must be positive.");
+        }
+        runRender(args[1], args[2], cell, every);
+    }
+    else
+    {
+        error(USAGE);
+    }
+
+    if (traceEnabled && !writeTrace(tracePath))
+    {
+        error("Cannot write trace file " + tracePath + ".");
+    }
+
+    return(0);
+}
@@ -0,0 +1,381 @@
+/*
+ * X drawing of the game. See snakeView.h.
+ */
+
+// Import header files.
+#include <utility>
+
+#include "snakeView.h"
+#include "tracer.h"
+
+using namespace std;
+
+// Declare list of pointers to displayable objects.
+list<Displayable *> dList;
+
+// Declare overlay scenes.
+Scene splashScene;
+Scene pauseScene;
+Scene gameOverScene;
+
+// Declare ScoreText object.
+ScoreText scoreText(HORIZONTAL_INFO_OFFSET , SCREEN_HEIGHT + 25);
+
+// Declare HUD, placed after the score, with its two lines either
+// side of the score's baseline.
+HudText hudText(HORIZONTAL_INFO_OFFSET + 100, SCREEN_HEIGHT + 18);
+
+// Declare Snake object.
+Snake snake;
+
+// Declare fruit object
+Fruit fruit;
+
+// Declare damage tracker.
+Damage damage;
+
+// Board image for the framebuffer renderer.
+static FrameBuffer boardImage;
+
+void GameView::capture(const GameState &game)
+{
+    width = game.getWidth();
+    height = game.getHeight();
+    const SnakeBody &snake = game.getBody();
+    body.resize(snake.size());
+    occupied.reset();
+    for (size_t i = 0; i < snake.size(); i++)
+    {
+        body[i] = snake[i];
+        occupied.set(snake[i]);
+    }
+    direction = game.getDirection();
+    fruit = game.getFruit();
+    score = game.getScore();
+    alive = game.isAlive();
+}
+
+void GameView::swap(GameView &other)
+{
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    body.swap(other.body);
+    std::swap(occupied, other.occupied);
+    std::swap(direction, other.direction);
+    std::swap(fruit, other.fruit);
+    std::swap(score, other.score);
+    std::swap(alive, other.alive);
+}
+
+/*
+ * Find the part of the next cell the head has moved into since the
+ * last tick, so motion between ticks is drawn smoothly at the display
+ * frame rate. Returns false when there is nothing to draw.
+ */
+bool leadRect(XInfo &xInfo, Cell &next, XRectangle &rect)
+{
+    if (!game.isAlive() || xInfo.tickInterval == 0)
+    {
+        return false;
+    }
+
+    int extent = PIXEL_WIDTH*xInfo.accumulator/xInfo.tickInterval;
+    if (extent <= 0)
+    {
+        return false;
+    }
+    if (extent > PIXEL_WIDTH)
+    {
+        extent = PIXEL_WIDTH;
+    }
+
+    next = neighbour(game.getBody().front(), game.getDirection());
+    if (!game.contains(next) || !xInfo.viewport.contains(next))
+    {
+        return false;
+    }
+
+    rect.x = cellPixelX(xInfo, next);
+    rect.y = cellPixelY(xInfo, next);
+    rect.width = PIXEL_WIDTH;
+    rect.height = PIXEL_WIDTH;
+    switch (game.getDirection())
+    {
+        case NORTH:
+            rect.y += PIXEL_WIDTH - extent;
+            rect.height = extent;
+            break;
+        case SOUTH:
+            rect.height = extent;
+            break;
+        case EAST:
+            rect.width = extent;
+            break;
+        case WEST:
+            rect.x += PIXEL_WIDTH - extent;
+            rect.width = extent;
+            break;
+    }
+    return true;
+}
+
+/*
+ * (Re)create the off-screen back buffer at the given window size.
+ */
+void createBuffer(XInfo &xInfo, int width, int height)
+{
+    if (xInfo.buffer != None)
+    {
+        XFreePixmap(xInfo.display, xInfo.buffer);
+    }
+    xInfo.width = width;
+    xInfo.height = height;
+    xInfo.buffer = XCreatePixmap(xInfo.display, xInfo.window, width, height,
+                    DefaultDepth(xInfo.display, xInfo.screenNumber));
+}
+
+/*
+ * Set up the given way of drawing the board.
+ */
+RendererType initRenderer(XInfo &xInfo, RendererType type)
+{
+    xInfo.frameBuffer = NULL;
+    boardImage.destroy();
+    if (type == FRAMEBUFFER_RENDERER
+        && boardImage.create(xInfo.display, xInfo.screenNumber,
+                             BOARD_PIXEL_WIDTH, BOARD_PIXEL_HEIGHT))
+    {
+        xInfo.frameBuffer = &boardImage;
+        return FRAMEBUFFER_RENDERER;
+    }
+    return PRIMITIVE_RENDERER;
+}
+
+// Fill a rectangle of the board in the back buffer, through the
+// framebuffer when there is one.
+static void fillBoardRect(XInfo &xInfo, int x, int y, int width, int height, bool on)
+{
+    if (xInfo.frameBuffer != NULL)
+    {
+        xInfo.frameBuffer->fillRect(x, y, width, height, on);
+    }
+    else
+    {
+        XFillRectangle(xInfo.display, xInfo.buffer, on ? xInfo.gc : xInfo.clearGC,
+                        x, y, width, height);
+    }
+}
+
+// Copy a rectangle of the board to the window, presenting it from
+// the framebuffer to the back buffer first when there is one.
+static void presentBoardRect(XInfo &xInfo, int x, int y, int width, int height)
+{
+    if (xInfo.frameBuffer != NULL)
+    {
+        xInfo.frameBuffer->put(xInfo.buffer, xInfo.gc, x, y, width, height);
+    }
+    XCopyArea(xInfo.display, xInfo.buffer, xInfo.window, xInfo.gc,
+                x, y, width, height, x, y);
+}
+
+/*
+ * Work out which screen is showing.
+ */
+FrameMode currentFrameMode()
+{
+    if (showSplash)
+    {
+        return SPLASH_FRAME;
+    }
+    else if (gamePaused)
+    {
+        return PAUSE_FRAME;
+    }
+    else if (!game.isAlive())
+    {
+        return GAME_OVER_FRAME;
+    }
+    return PLAY_FRAME;
+}
+
+/*
+ * Redraw the whole frame into the back buffer and copy it
+ * to the window.
+ */
+void repaintAll(XInfo &xInfo)
+{
+    // Compose the frame in the back buffer.
+    XFillRectangle(xInfo.display, xInfo.buffer, xInfo.clearGC,
+                    0, 0, xInfo.width, xInfo.height);
+
+    // The board is rasterized and presented as one image while
+    // playing; the splash text shares its area, so is left alone.
+    bool boardImaged = (xInfo.frameBuffer != NULL && currentFrameMode() == PLAY_FRAME);
+    if (boardImaged)
+    {
+        xInfo.frameBuffer->clear();
+    }
+    if (!gamePaused && game.isAlive())
+    {
+        list<Displayable *>::const_iterator begin = dList.begin();
+        list<Displayable *>::const_iterator end = dList.end();
+
+        while(begin != end)
+        {
+            // Note: Here a pointer is set to the value pointed to by
+            // begin, which is the address contained in dList.
+            Displayable * d = *begin;
+            d->paint(xInfo);
+            begin++;
+        }
+        hudText.paint(xInfo);
+    }
+    else if (gamePaused)
+    {
+        pauseScene.paint(xInfo);
+    }
+    else if (!game.isAlive())
+    {
+        gameOverScene.paint(xInfo);
+    }
+    if (boardImaged)
+    {
+        xInfo.frameBuffer->put(xInfo.buffer, xInfo.gc, 0, 0,
+                               BOARD_PIXEL_WIDTH, BOARD_PIXEL_HEIGHT);
+    }
+
+    // Mark the edges of a board smaller than the window.
+    if (currentFrameMode() == PLAY_FRAME)
+    {
+        int right = xInfo.viewport.width*PIXEL_WIDTH;
+        int bottom = xInfo.viewport.height*PIXEL_WIDTH;
+        if (right < BOARD_PIXEL_WIDTH)
+        {
+            XDrawLine(xInfo.display, xInfo.buffer, xInfo.gc, right + 1, 0, right + 1, bottom + 1);
+        }
+        if (bottom < BOARD_PIXEL_HEIGHT)
+        {
+            XDrawLine(xInfo.display, xInfo.buffer, xInfo.gc, 0, bottom + 1, right + 1, bottom + 1);
+        }
+    }
+
+    // Present it with a single copy to the window.
+    XCopyArea(xInfo.display, xInfo.buffer, xInfo.window, xInfo.gc,
+                0, 0, xInfo.width, xInfo.height, 0, 0);
+
+    XRectangle lead;
+    damage.hasLead = (currentFrameMode() == PLAY_FRAME
+                        && leadRect(xInfo, damage.leadCell, lead));
+}
+
+/*
+ * Redraw only the damaged cells and the score, and copy just
+ * those areas to the window.
+ */
+void repaintDamage(XInfo &xInfo)
+{
+    // The lead drawn last frame has to be erased or overwritten.
+    if (damage.hasLead)
+    {
+        damage.cells.push_back(damage.leadCell);
+    }
+
+    // Draw every changed cell and the head's progress into the next
+    // cell before copying any of them, so the framebuffer is not
+    // waited on between cells.
+    Cell fruitLoc = game.getFruit();
+    for (size_t i = 0; i < damage.cells.size(); i++)
+    {
+        Cell cell = damage.cells[i];
+        if (!xInfo.viewport.contains(cell))
+        {
+            continue;
+        }
+        bool on = game.covers(cell) || (cell.x == fruitLoc.x && cell.y == fruitLoc.y);
+        fillBoardRect(xInfo, cellPixelX(xInfo, cell), cellPixelY(xInfo, cell),
+                      PIXEL_WIDTH, PIXEL_WIDTH, on);
+    }
+    XRectangle lead;
+    damage.hasLead = leadRect(xInfo, damage.leadCell, lead);
+    if (damage.hasLead)
+    {
+        fillBoardRect(xInfo, lead.x, lead.y, lead.width, lead.height, true);
+    }
+
+    for (size_t i = 0; i < damage.cells.size(); i++)
+    {
+        Cell cell = damage.cells[i];
+        if (xInfo.viewport.contains(cell))
+        {
+            presentBoardRect(xInfo, cellPixelX(xInfo, cell), cellPixelY(xInfo, cell),
+                             PIXEL_WIDTH, PIXEL_WIDTH);
+        }
+    }
+    if (damage.hasLead)
+    {
+        presentBoardRect(xInfo, lead.x, lead.y, lead.width, lead.height);
+    }
+
+    // Redraw the info bar, including its top line, when the score
+    // or the HUD changes.
+    if (game.getScore() != damage.score || damage.info)
+    {
+        damage.score = game.getScore();
+        damage.info = false;
+        XFillRectangle(xInfo.display, xInfo.buffer, xInfo.clearGC,
+                        0, SCREEN_HEIGHT - 1, xInfo.width, xInfo.height - SCREEN_HEIGHT + 1);
+        scoreText.paint(xInfo);
+        hudText.paint(xInfo);
+        XCopyArea(xInfo.display, xInfo.buffer, xInfo.window, xInfo.gc,
+                    0, SCREEN_HEIGHT - 1, xInfo.width, xInfo.height - SCREEN_HEIGHT + 1,
+                    0, SCREEN_HEIGHT - 1);
+    }
+}
+
+/*
+ * Function to draw displayables to the window. Only the cells
+ * changed since the last frame are redrawn, unless the screen
+ * being shown has changed or a full repaint was requested.
+ */
+void repaint(XInfo &xInfo)
+{
+    // Scrolling the view redraws the whole board.
+    FrameMode mode = currentFrameMode();
+    if (xInfo.viewport.follow(game, BOARD_WIDTH, BOARD_HEIGHT))
+    {
+        damage.full = true;
+    }
+    if (damage.full || mode != damage.mode)
+    {
+        repaintAll(xInfo);
+        damage.full = false;
+        damage.mode = mode;
+        damage.score = game.getScore();
+        damage.info = false;
+    }
+    else if (mode == PLAY_FRAME)
+    {
+        repaintDamage(xInfo);
+    }
+    damage.cells.clear();
+
+    TraceSpan span("XFlush");
+    XFlush(xInfo.display);
+}
+
+/*
+ * Build the splash, pause and game over overlays once.
+ */
+void initScenes()
+{
+    splashScene.addLine(SCREEN_HEIGHT/2 - 25, "Snake!");
+    splashScene.addLine(SCREEN_HEIGHT/2, "Created by: Christopher Mannes");
+    splashScene.addLine(SCREEN_HEIGHT/2 + 25, "Press left, right, up, and down arrow keys to direct the snake.");
+    splashScene.addLine(SCREEN_HEIGHT/2 + 50, "Press p to pause, q to quit, and spacebar to start.");
+
+    pauseScene.addLine(SCREEN_HEIGHT/2 - 25, "Game Paused");
+    pauseScene.addLine(SCREEN_HEIGHT/2, "Press p again to resume or q to quit.");
+
+    gameOverScene.addLine(SCREEN_HEIGHT/2 - 25, "Game Over");
+    gameOverScene.addLine(SCREEN_HEIGHT/2, "Press Spacebar to re-start or q to quit.");
+}
@@ -0,0 +1,431 @@
+/*
+ * X drawing of the game for the snakeGame front-end: the window and
+ * its back buffer, the displayable objects, and the damage-tracked
+ * repaint. Kept apart from the event loop so other programs, such as
+ * the benchmarks, can draw a game the same way.
+ */
+#ifndef SNAKE_VIEW_H
+#define SNAKE_VIEW_H
+
+#include <list>
+#include <string>
+#include <vector>
+
+// Header files for X functions.
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include "gameState.h"
+#include "frameBuffer.h"
+#include "viewport.h"
+
+// Screen parameters.
+const int SCREEN_HEIGHT = 750;
+const int SCREEN_WIDTH = 800;
+const int INFO_OFFSET = 40;
+const int WINDOW_CORNER_X = 10;
+const int WINDOW_CORNER_Y = 10;
+const int BORDER_SIZE = 5;
+const int HORIZONTAL_INFO_OFFSET = 25;
+
+// Snake parameters.
+const int PIXEL_WIDTH = 20;
+
+// Size in pixels of the area of the window the board is drawn in,
+// which shows the whole of the default board or a scrolling view of
+// a larger one.
+const int BOARD_PIXEL_WIDTH = BOARD_WIDTH*PIXEL_WIDTH;
+const int BOARD_PIXEL_HEIGHT = BOARD_HEIGHT*PIXEL_WIDTH;
+
+/*
+ * A struct containing the display, window, the off-screen
+ * buffer frames are composed into and its size, screenNumber,
+ * graphic contexts, the framebuffer the board is rasterized into
+ * (NULL to draw it with Xlib primitives), the part of the board
+ * shown, the fixed tick interval, and the time since the last
+ * tick, which sets how far the head is drawn into the next cell.
+ */
+struct XInfo {
+    Display * display;
+    Window window;
+    Pixmap buffer;
+    int width;
+    int height;
+    int screenNumber;
+    GC gc;
+    GC clearGC;
+    FrameBuffer * frameBuffer;
+    Viewport viewport;
+    unsigned long tickInterval;
+    unsigned long accumulator;
+};
+
+/*
+ * The part of a game the view draws: the board size, the body, the
+ * fruit, the score and where the snake is heading. Taking one from
+ * a GameState costs the length of the snake and reuses the storage
+ * of the last, leaving behind the free-cell index and the other
+ * bookkeeping only the simulation needs.
+ */
+class GameView {
+    public:
+        // Copy what is drawn from a game.
+        void capture(const GameState &game);
+
+        void swap(GameView &other);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        bool contains(Cell cell) const
+        {
+            return cell.x >= 0 && cell.y >= 0 && cell.x < width && cell.y < height;
+        }
+
+        bool isAlive() const { return alive; }
+        int getScore() const { return score; }
+        Direction getDirection() const { return direction; }
+        Cell getFruit() const { return fruit; }
+
+        // Body cells ordered from head to tail.
+        const std::vector<Cell> &getBody() const { return body; }
+
+        // Whether the snake covers the given cell.
+        bool covers(Cell cell) const { return occupied.test(cell); }
+
+        // Starts out showing a new game.
+        GameView()
+        {
+            capture(GameState());
+        }
+
+    private:
+        int width;
+        int height;
+        std::vector<Cell> body;
+        OccupancyGrid occupied;
+        Direction direction;
+        Cell fruit;
+        int score;
+        bool alive;
+};
+
+// Front-end state that decides what is drawn, defined by the
+// program using the view.
+extern GameView game;
+extern bool showSplash;
+extern bool gamePaused;
+
+/*
+ * Find the part of the next cell the head has moved into since the
+ * last tick, so motion between ticks is drawn smoothly at the display
+ * frame rate. Returns false when there is nothing to draw.
+ */
+bool leadRect(XInfo &xInfo, Cell &next, XRectangle &rect);
+
+/*
+ * Where a board cell is drawn in the window, in pixels.
+ */
+inline int cellPixelX(const XInfo &xInfo, Cell cell)
+{
+    return (cell.x - xInfo.viewport.x)*PIXEL_WIDTH;
+}
+
+inline int cellPixelY(const XInfo &xInfo, Cell cell)
+{
+    return (cell.y - xInfo.viewport.y)*PIXEL_WIDTH;
+}
+
+/*
+ * An abstract class for displayable objects.
+ */
+class Displayable {
+    public:
+        virtual void paint(XInfo &xInfo) = 0;
+};
+
+/*
+ * A text displayable class derived from Displayable.
+ */
+class Text: public Displayable {
+    public:
+        virtual void paint(XInfo &xInfo) 
+        {
+            XDrawImageString(xInfo.display, xInfo.buffer, xInfo.gc,
+                            this->x, this->y, this->s.c_str(), this->s.length());
+        }
+
+        Text(int x, int y, std::string s): x(x), y(y), s(s)
+        {
+            // Set member variables to input variables.
+        }
+
+    private:
+        int x;
+        int y;
+        std::string s;
+};
+// List of pointers to displayable objects.
+extern std::list<Displayable *> dList;
+
+/*
+ * A scene displayable class derived from Displayable. A scene owns
+ * a fixed set of centred text lines that is built once and then
+ * repainted every frame without further allocation.
+ */
+class Scene: public Displayable {
+    public:
+        virtual void paint(XInfo &xInfo)
+        {
+            for (size_t i = 0; i < lines.size(); i++)
+            {
+                lines[i].paint(xInfo);
+            }
+        }
+
+        // Add a line of text centred horizontally at height y.
+        void addLine(int y, std::string s)
+        {
+            lines.push_back(Text(SCREEN_WIDTH/2 - 3*s.length(), y, s));
+        }
+
+    private:
+        std::vector<Text> lines;
+};
+// Overlay scenes.
+extern Scene splashScene;
+extern Scene pauseScene;
+extern Scene gameOverScene;
+
+/*
+ * A scoreText displayable class derived from Displayable.
+ */
+class ScoreText: public Displayable {
+    public:
+        virtual void paint (XInfo &xInfo)
+        {
+            // Only rebuild the string when the score changes.
+            if (game.getScore() != shownScore)
+            {
+                shownScore = game.getScore();
+                scoreDisplay = "Score: " + std::to_string(shownScore);
+            }
+
+            XDrawLine(xInfo.display, xInfo.buffer, xInfo.gc,
+                            0, SCREEN_HEIGHT, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+            XDrawImageString(xInfo.display, xInfo.buffer, xInfo.gc,
+                            this->x, this->y,
+                            this->scoreDisplay.c_str(), this->scoreDisplay.length());
+        }
+
+        ScoreText(int x, int y): x(x), y(y)
+        {
+            shownScore = 0;
+            scoreDisplay = "Score: " + std::to_string(shownScore);
+        }
+
+    private:
+        int x;
+        int y;
+        int shownScore;
+        std::string scoreDisplay;
+};
+extern ScoreText scoreText;
+
+/*
+ * Lines of performance figures drawn in the info bar beside the
+ * score. Nothing is drawn unless the HUD has been switched on.
+ */
+class HudText: public Displayable {
+    public:
+        // Spacing of the lines, in pixels, for the default font.
+        static const int LINE_HEIGHT = 13;
+
+        virtual void paint(XInfo &xInfo)
+        {
+            if (!shown)
+            {
+                return;
+            }
+            size_t start = 0;
+            for (int line = 0; start <= s.length(); line++)
+            {
+                size_t end = s.find('\n', start);
+                if (end == std::string::npos)
+                {
+                    end = s.length();
+                }
+                XDrawImageString(xInfo.display, xInfo.buffer, xInfo.gc,
+                                this->x, this->y + line*LINE_HEIGHT, s.c_str() + start, end - start);
+                start = end + 1;
+            }
+        }
+
+        void show() { shown = true; }
+
+        // Replace the text, returning whether it changed.
+        bool setText(const std::string &text)
+        {
+            if (text == s)
+            {
+                return false;
+            }
+            s = text;
+            return true;
+        }
+
+        HudText(int x, int y): x(x), y(y), shown(false)
+        {
+        }
+
+    private:
+        int x;
+        int y;
+        bool shown;
+        std::string s;
+};
+extern HudText hudText;
+
+/*
+ * A snake displayable class derived from Displayable.
+ * Draws the body cells in view with a single XFillRectangles
+ * request, or into the framebuffer.
+ */
+class Snake : public Displayable {
+    public:
+        virtual void paint(XInfo &xInfo)
+        {
+            const std::vector<Cell> &body = game.getBody();
+
+            // Only grow the rectangle buffer when the snake has,
+            // leaving room for the interpolated lead.
+            if (rects.size() < body.size() + 1)
+            {
+                rects.resize(body.size()*2 + 1);
+            }
+            size_t count = 0;
+            for (size_t i = 0; i < body.size(); i++)
+            {
+                if (xInfo.viewport.contains(body[i]))
+                {
+                    rects[count].x = cellPixelX(xInfo, body[i]);
+                    rects[count].y = cellPixelY(xInfo, body[i]);
+                    rects[count].width = PIXEL_WIDTH;
+                    rects[count].height = PIXEL_WIDTH;
+                    count++;
+                }
+            }
+            Cell next;
+            if (leadRect(xInfo, next, rects[count]))
+            {
+                count++;
+            }
+            if (xInfo.frameBuffer != NULL)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    xInfo.frameBuffer->fillRect(rects[i].x, rects[i].y,
+                                                rects[i].width, rects[i].height, true);
+                }
+                return;
+            }
+            XFillRectangles(xInfo.display, xInfo.buffer, xInfo.gc,
+                            &rects[0], count);
+        }
+
+    private:
+        std::vector<XRectangle> rects;
+};
+extern Snake snake;
+
+/*
+ * A fruit displayable class derived from Displayable.
+ */
+class Fruit: public Displayable {
+    public:
+        virtual void paint(XInfo &xInfo)
+        {
+            Cell fruitLoc = game.getFruit();
+            if (!xInfo.viewport.contains(fruitLoc))
+            {
+                return;
+            }
+            if (xInfo.frameBuffer != NULL)
+            {
+                xInfo.frameBuffer->fillRect(cellPixelX(xInfo, fruitLoc), cellPixelY(xInfo, fruitLoc),
+                                            PIXEL_WIDTH, PIXEL_WIDTH, true);
+                return;
+            }
+            XFillRectangle(xInfo.display, xInfo.buffer, xInfo.gc,
+                            cellPixelX(xInfo, fruitLoc),
+                            cellPixelY(xInfo, fruitLoc),
+                            PIXEL_WIDTH, PIXEL_WIDTH);
+        }
+};
+extern Fruit fruit;
+
+/*
+ * Screens that can be showing.
+ */
+enum FrameMode {SPLASH_FRAME, PLAY_FRAME, PAUSE_FRAME, GAME_OVER_FRAME};
+
+/*
+ * Damage recorded between frames: the cells changed by the ticks
+ * since the last repaint, whether the whole window must be redrawn,
+ * the cell the interpolated lead was last drawn into, and the screen
+ * and score that were last drawn.
+ */
+struct Damage {
+    std::vector<Cell> cells;
+    bool full;
+    bool hasLead;
+    Cell leadCell;
+    FrameMode mode;
+    int score;
+    bool info;
+};
+extern Damage damage;
+
+/*
+ * (Re)create the off-screen back buffer at the given window size.
+ */
+void createBuffer(XInfo &xInfo, int width, int height);
+
+/*
+ * Set up the given way of drawing the board, releasing the previous
+ * one. Returns the renderer in use, which is the primitive one if a
+ * framebuffer cannot be made for the display.
+ */
+RendererType initRenderer(XInfo &xInfo, RendererType type);
+
+/*
+ * Work out which screen is showing.
+ */
+FrameMode currentFrameMode();
+
+/*
+ * Redraw the whole frame into the back buffer and copy it
+ * to the window.
+ */
+void repaintAll(XInfo &xInfo);
+
+/*
+ * Redraw only the damaged cells and the score, and copy just
+ * those areas to the window.
+ */
+void repaintDamage(XInfo &xInfo);
+
+/*
+ * Function to draw displayables to the window. Only the cells
+ * changed since the last frame are redrawn, unless the screen
+ * being shown has changed or a full repaint was requested.
+ */
+void repaint(XInfo &xInfo);
+
+/*
+ * Build the splash, pause and game over overlays once.
+ */
+void initScenes();
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * A bounded lock-free queue for one producer thread and one consumer
+ * thread.
+ *
+ * Each side only writes its own index and reads the other's, so a
+ * push or pop is a couple of atomic loads and one release store. The
+ * indexes sit on separate cache lines so the two threads do not keep
+ * taking the line from each other.
+ */
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <stddef.h>
+
+template <class T>
+class SpscQueue {
+    public:
+        // Add an item, from the producer thread. Returns false, and
+        // drops the item, when the queue is full.
+        bool push(const T &item)
+        {
+            size_t tail = writeIndex.load(std::memory_order_relaxed);
+            if (tail - readIndex.load(std::memory_order_acquire) == items.size())
+            {
+                return false;
+            }
+            items[tail & mask] = item;
+            writeIndex.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Take the oldest item, from the consumer thread. Returns
+        // false when the queue is empty.
+        bool pop(T &item)
+        {
+            size_t head = readIndex.load(std::memory_order_relaxed);
+            if (head == writeIndex.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = items[head & mask];
+            readIndex.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return readIndex.load(std::memory_order_acquire)
+                   == writeIndex.load(std::memory_order_acquire);
+        }
+
+        // The capacity is rounded up to a power of two.
+        SpscQueue(size_t capacity): readIndex(0), writeIndex(0)
+        {
+            size_t size = 1;
+            while (size < capacity)
+            {
+                size *= 2;
+            }
+            items.resize(size);
+            mask = size - 1;
+        }
+
+    private:
+        std::vector<T> items;
+        size_t mask;
+        alignas(64) std::atomic<size_t> readIndex;
+        alignas(64) std::atomic<size_t> writeIndex;
+};
+
+#endif
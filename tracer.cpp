@@ -0,0 +1,129 @@
+/*
+ * Timeline tracing. See tracer.h.
+ */
+
+// Import header files.
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include <time.h>
+
+#include "tracer.h"
+
+using namespace std;
+
+bool traceEnabled = false;
+
+/*
+ * The spans recorded by one thread. Buffers are never freed, so the
+ * spans of threads that have finished can still be written out.
+ */
+struct TraceBuffer {
+    struct Span {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    vector<Span> spans;
+    uint64_t next;
+    int thread;
+    const char *name;
+
+    TraceBuffer(int thread): spans(TRACE_CAPACITY), next(0), thread(thread), name(NULL)
+    {
+    }
+};
+
+static mutex registryLock;
+static vector<TraceBuffer *> registry;
+static uint64_t traceStart;
+static thread_local TraceBuffer *localBuffer = NULL;
+
+static TraceBuffer *threadBuffer()
+{
+    if (localBuffer == NULL)
+    {
+        lock_guard<mutex> guard(registryLock);
+        localBuffer = new TraceBuffer(registry.size() + 1);
+        registry.push_back(localBuffer);
+    }
+    return localBuffer;
+}
+
+void startTracing()
+{
+    traceStart = traceClock();
+    traceEnabled = true;
+}
+
+uint64_t traceClock()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+void traceRecord(const char *name, uint64_t start, uint64_t end)
+{
+    TraceBuffer *buffer = threadBuffer();
+    TraceBuffer::Span &span = buffer->spans[buffer->next & (TRACE_CAPACITY - 1)];
+    span.name = name;
+    span.start = start;
+    span.end = end;
+    buffer->next++;
+}
+
+void traceThreadName(const char *name)
+{
+    if (traceEnabled)
+    {
+        threadBuffer()->name = name;
+    }
+}
+
+// Microseconds since tracing started, as the format expects.
+static double traceMicros(uint64_t time)
+{
+    return (time > traceStart) ? (time - traceStart)/1000.0 : 0;
+}
+
+bool writeTrace(const string &path)
+{
+    ofstream out(path.c_str());
+    if (!out.is_open())
+    {
+        return false;
+    }
+    out.setf(ios::fixed);
+    out.precision(3);
+
+    lock_guard<mutex> guard(registryLock);
+    out << "{\"traceEvents\": [" << endl;
+    bool first = true;
+    for (size_t b = 0; b < registry.size(); b++)
+    {
+        const TraceBuffer &buffer = *registry[b];
+        if (buffer.name != NULL)
+        {
+            out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", "
+                << "\"pid\": 1, \"tid\": " << buffer.thread
+                << ", \"args\": {\"name\": \"" << buffer.name << "\"}}";
+            first = false;
+        }
+
+        // Oldest span first once the ring has wrapped.
+        uint64_t begin = (buffer.next > TRACE_CAPACITY) ? buffer.next - TRACE_CAPACITY : 0;
+        for (uint64_t i = begin; i < buffer.next; i++)
+        {
+            const TraceBuffer::Span &span = buffer.spans[i & (TRACE_CAPACITY - 1)];
+            out << (first ? "" : ",\n") << "{\"name\": \"" << span.name
+                << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer.thread
+                << ", \"ts\": " << traceMicros(span.start)
+                << ", \"dur\": " << (span.end - span.start)/1000.0 << "}";
+            first = false;
+        }
+    }
+    out << "\n]}" << endl;
+    return out.good();
+}
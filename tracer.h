@@ -0,0 +1,63 @@
+/*
+ * Timeline tracing in the Chrome trace format, loadable in
+ * chrome://tracing or Perfetto.
+ *
+ * Spans are recorded into a ring buffer owned by the thread that
+ * records them, so the hot path takes no locks: a lock is only taken
+ * the first time a thread records, to register its buffer. Each
+ * buffer keeps the most recent TRACE_CAPACITY spans. When tracing is
+ * off a span costs one branch.
+ */
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <stddef.h>
+#include <stdint.h>
+
+// Spans kept per thread, a power of two.
+const size_t TRACE_CAPACITY = 65536;
+
+// Whether spans are being recorded. Set by startTracing() before any
+// thread records.
+extern bool traceEnabled;
+
+void startTracing();
+
+// Nanoseconds from a clock that never jumps.
+uint64_t traceClock();
+
+// Record a finished span. The name must outlive the tracer, such as
+// a string literal.
+void traceRecord(const char *name, uint64_t start, uint64_t end);
+
+// Name the calling thread in the trace.
+void traceThreadName(const char *name);
+
+// Write every buffered span as JSON. Threads should not be recording
+// while this runs. Returns false if the file cannot be written.
+bool writeTrace(const std::string &path);
+
+/*
+ * Records the scope it lives in as a span.
+ */
+class TraceSpan {
+    public:
+        TraceSpan(const char *name): name(name), start(traceEnabled ? traceClock() : 0)
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if (traceEnabled)
+            {
+                traceRecord(name, start, traceClock());
+            }
+        }
+
+    private:
+        const char *name;
+        uint64_t start;
+};
+
+#endif
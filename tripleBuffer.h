@@ -0,0 +1,61 @@
+/*
+ * Hands the latest value from one writer thread to one reader thread
+ * without locks or waiting.
+ *
+ * Of the three copies the writer owns one, the reader owns one and
+ * the third holds the last value published. Publishing and taking
+ * each swap a copy with the third in one atomic exchange, so neither
+ * side ever waits for the other or sees a half-written value. Values
+ * the reader had no time to take are overwritten by newer ones.
+ */
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+template <class T>
+class TripleBuffer {
+    public:
+        // The copy the writer fills in before publishing it.
+        T &writeBuffer() { return buffers[back]; }
+
+        // Publish the write buffer and start on another copy. Returns
+        // whether the reader took the previously published value
+        // before it was replaced.
+        bool publish()
+        {
+            int old = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+            back = old & INDEX;
+            return !(old & FRESH);
+        }
+
+        // Take the latest published value, if there is a new one.
+        bool update()
+        {
+            if (!(middle.load(std::memory_order_acquire) & FRESH))
+            {
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        // The copy the reader last took. The reader may change it, or
+        // swap its contents out, until it takes the next.
+        T &readBuffer() { return buffers[front]; }
+
+        TripleBuffer(): middle(1), back(0), front(2)
+        {
+        }
+
+    private:
+        static const int INDEX = 3;
+        static const int FRESH = 4;
+
+        T buffers[3];
+        std::atomic<int> middle;
+        int back;
+        int front;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * The part of the board a view shows, in cells. On a board larger
+ * than the view it follows the snake's head, jumping to centre on the
+ * head whenever the head comes within a quarter of the view of an
+ * edge, so the view only has to be redrawn in full now and then.
+ */
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+#include <algorithm>
+
+#include "gameState.h"
+
+struct Viewport {
+    // Board cell at the top left, and size in cells.
+    int x;
+    int y;
+    int width;
+    int height;
+
+    bool contains(Cell cell) const
+    {
+        return cell.x >= x && cell.y >= y && cell.x < x + width && cell.y < y + height;
+    }
+
+    // Show as much of the game's board as fits in maxWidth by
+    // maxHeight cells, scrolling to keep the head in view. Returns
+    // whether the view moved or changed size.
+    template <class Game>
+    bool follow(const Game &game, int maxWidth, int maxHeight)
+    {
+        int w = std::min(game.getWidth(), maxWidth);
+        int h = std::min(game.getHeight(), maxHeight);
+        bool moved = (w != width || h != height);
+        width = w;
+        height = h;
+
+        Cell head = game.getBody().front();
+        int marginX = width/4;
+        int marginY = height/4;
+        if (moved || head.x < x + marginX || head.x >= x + width - marginX
+            || head.y < y + marginY || head.y >= y + height - marginY)
+        {
+            // Centre on the head without leaving the board.
+            int newX = std::max(0, std::min(head.x - width/2, game.getWidth() - width));
+            int newY = std::max(0, std::min(head.y - height/2, game.getHeight() - height));
+            moved |= (newX != x || newY != y);
+            x = newX;
+            y = newY;
+        }
+        return moved;
+    }
+
+    Viewport(): x(0), y(0), width(0), height(0)
+    {
+    }
+};
+
+#endif
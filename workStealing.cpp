@@ -0,0 +1,94 @@
+/*
+ * A work-stealing scheduler. See workStealing.h.
+ */
+
+// Import header files.
+#include <thread>
+
+#include "workStealing.h"
+
+using namespace std;
+
+static int defaultWorkerCount(int workerCount)
+{
+    if (workerCount > 0)
+    {
+        return workerCount;
+    }
+    int hardware = thread::hardware_concurrency();
+    return (hardware > 0) ? hardware : 1;
+}
+
+WorkStealingScheduler::WorkStealingScheduler(int workerCount):
+    workerCount(defaultWorkerCount(workerCount)),
+    queues(defaultWorkerCount(workerCount))
+{
+}
+
+void WorkStealingScheduler::run(int jobCount, const function<void(int, int)> &job)
+{
+    // Deal the jobs out in contiguous blocks.
+    for (int w = 0; w < workerCount; w++)
+    {
+        int first = (long)jobCount*w/workerCount;
+        int last = (long)jobCount*(w + 1)/workerCount;
+        for (int j = first; j < last; j++)
+        {
+            queues[w].jobs.push_back(j);
+        }
+    }
+
+    // The calling thread works as worker zero.
+    vector<thread> threads;
+    for (int w = 1; w < workerCount; w++)
+    {
+        threads.push_back(thread(&WorkStealingScheduler::work, this, w, cref(job)));
+    }
+    work(0, job);
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+}
+
+void WorkStealingScheduler::work(int worker, const function<void(int, int)> &job)
+{
+    // No jobs are added while running, so once there is nothing left
+    // to take or steal this worker is done.
+    int next;
+    while (take(worker, next) || steal(worker, next))
+    {
+        job(next, worker);
+    }
+}
+
+// Take the most recently dealt job from this worker's own queue.
+bool WorkStealingScheduler::take(int worker, int &job)
+{
+    WorkQueue &queue = queues[worker];
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.jobs.empty())
+    {
+        return false;
+    }
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+// Steal the oldest job from another worker, trying each in turn.
+bool WorkStealingScheduler::steal(int worker, int &job)
+{
+    for (int i = 1; i < workerCount; i++)
+    {
+        WorkQueue &queue = queues[(worker + i) % workerCount];
+        lock_guard<mutex> guard(queue.lock);
+        if (!queue.jobs.empty())
+        {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
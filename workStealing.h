@@ -0,0 +1,44 @@
+/*
+ * A work-stealing scheduler for running many independent jobs, such
+ * as whole games, across all cores.
+ *
+ * Jobs are dealt out to the workers in contiguous blocks. Each worker
+ * takes jobs from the back of its own queue and, once that is empty,
+ * steals from the front of the other workers' queues, so uneven job
+ * lengths still keep every core busy until the last job is done.
+ */
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class WorkStealingScheduler {
+    public:
+        // Run jobs 0 to jobCount - 1 and wait for all of them. Each
+        // call is passed the job index and the index of the worker
+        // running it, so jobs can use per-worker scratch state.
+        void run(int jobCount, const std::function<void(int, int)> &job);
+
+        int size() const { return workerCount; }
+
+        // A worker count of zero uses one worker per hardware thread.
+        WorkStealingScheduler(int workerCount);
+
+    private:
+        struct WorkQueue {
+            std::mutex lock;
+            std::deque<int> jobs;
+        };
+
+        int workerCount;
+        std::vector<WorkQueue> queues;
+
+        void work(int worker, const std::function<void(int, int)> &job);
+        bool take(int worker, int &job);
+        bool steal(int worker, int &job);
+};
+
+#endif